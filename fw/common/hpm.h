@@ -0,0 +1,76 @@
+#pragma once
+
+#include <inttypes.h>
+
+// Zihpm performance counters (rtl/csr/rv_csr_hpm.sv), the core needs
+// EXTENSION_Zihpm=1. Events are the same as `HPM_EV_* of rtl/rv_defines.vh.
+#define HPM_EV_NONE             0
+#define HPM_EV_FETCH_EMPTY      1   // decode waits for the fetch buffer
+#define HPM_EV_DATA_STALL       2   // decode stalled on memory data
+#define HPM_EV_MULDIV_BUSY      3   // mul/div in progress
+#define HPM_EV_FLUSH            4   // pipeline flush, pc change
+#define HPM_EV_BTB_HIT          5   // branch taken as predicted by the BTB
+#define HPM_EV_BTB_MISS         6   // branch mispredicted or missed the BTB
+#define HPM_EV_BUS_CONFLICT     7   // instruction fetch held off by a data access
+#define HPM_EV_BTB_LOST         8   // BTB lookup lost to an insert/removal
+
+// mhpmcounter3..6 are implemented (HPM_COUNTERS of rv_top_wb)
+#define HPM_COUNTERS            4
+#define HPM_FIRST               3
+
+// CSR numbers must be immediates, so counters are selected by a literal number
+#define HPM_SET_EVENT(n, ev) \
+    asm volatile ("csrw mhpmevent" #n ", %0" :: "r"(ev))
+
+// upper half is cleared, the counter should be stopped
+#define HPM_WRITE(n, val) \
+    ({ asm volatile ("csrw mhpmcounter" #n ", %0" :: "r"(val)); \
+       asm volatile ("csrw mhpmcounter" #n "h, zero"); })
+
+#define HPM_READ(n) \
+    ({ uint32_t __hi, __lo, __hi2; \
+       do { \
+           asm volatile ("csrr %0, mhpmcounter" #n "h" : "=r"(__hi)); \
+           asm volatile ("csrr %0, mhpmcounter" #n : "=r"(__lo)); \
+           asm volatile ("csrr %0, mhpmcounter" #n "h" : "=r"(__hi2)); \
+       } while (__hi != __hi2); \
+       ((uint64_t)__hi << 32) | __lo; })
+
+// counter 3..6 by a run-time index
+static inline uint64_t hpm_read(uint32_t n)
+{
+    switch (n)
+    {
+    case 3: return HPM_READ(3);
+    case 4: return HPM_READ(4);
+    case 5: return HPM_READ(5);
+    case 6: return HPM_READ(6);
+    default: return 0;
+    }
+}
+
+// stops the counters, clears them and selects events for mhpmcounter3..6
+static inline void hpm_start(uint32_t ev3, uint32_t ev4, uint32_t ev5, uint32_t ev6)
+{
+    HPM_SET_EVENT(3, HPM_EV_NONE);
+    HPM_SET_EVENT(4, HPM_EV_NONE);
+    HPM_SET_EVENT(5, HPM_EV_NONE);
+    HPM_SET_EVENT(6, HPM_EV_NONE);
+    HPM_WRITE(3, 0);
+    HPM_WRITE(4, 0);
+    HPM_WRITE(5, 0);
+    HPM_WRITE(6, 0);
+    HPM_SET_EVENT(3, ev3);
+    HPM_SET_EVENT(4, ev4);
+    HPM_SET_EVENT(5, ev5);
+    HPM_SET_EVENT(6, ev6);
+}
+
+// freezes mhpmcounter3..6, values stay readable
+static inline void hpm_stop(void)
+{
+    HPM_SET_EVENT(3, HPM_EV_NONE);
+    HPM_SET_EVENT(4, HPM_EV_NONE);
+    HPM_SET_EVENT(5, HPM_EV_NONE);
+    HPM_SET_EVENT(6, HPM_EV_NONE);
+}
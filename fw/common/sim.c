@@ -20,18 +20,42 @@ void sim_exit(uint32_t code)
     WRITE_REG32(COMM_ADDR, (EXIT_CODE | code));
 }
 
+// notifies the simulation harness about a point of interest (e.g. start of the
+// timed region), used as a checkpoint trigger and a region of the statistics
+void sim_marker(void)
+{
+    uint32_t data = (cnt << 8) | SIM_MARKER;
+    WRITE_REG32(COMM_ADDR, data);
+    ++cnt;
+}
+
 void xfunc_out(unsigned char ch)
 {
     sim_send_ch(ch);
 }
 
+// passes a whole buffer to the harness in one mailbox transaction, channel 0
+// is the console, others are stored into mailbox_<ch>.bin files
+void sim_send_block(uint8_t ch, const void* data, uint32_t size)
+{
+    WRITE_REG32(MAILBOX_BUF_ADDR, (uint32_t)data);
+    WRITE_REG32(MAILBOX_BUF_LEN, size);
+    WRITE_REG32(MAILBOX_CMD, (cnt << 8) | ch);
+    ++cnt;
+}
+
+// the mailbox exists only in simulation (TO_SIM), other builds write COMM_ADDR
 void sim_send_str(const char* const str)
 {
+#ifdef SIM
+    sim_send_block(MAILBOX_CONSOLE, str, strlen(str));
+#else
     uint32_t len = strlen(str);
     for (uint32_t i=0 ; i<len ; ++i)
     {
         sim_send_ch(str[i]);
     }
+#endif
 }
 
 int _kill(int pid, int sig)
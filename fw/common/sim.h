@@ -4,9 +4,15 @@
 
 #define CNT_ADDR 0x20000000
 #define COMM_ADDR 0xf0000000
+#define MAILBOX_ADDR 0x30000000
+#define MAILBOX_BUF_ADDR (MAILBOX_ADDR + 0x0)
+#define MAILBOX_BUF_LEN (MAILBOX_ADDR + 0x4)
+#define MAILBOX_CMD (MAILBOX_ADDR + 0x8)
+#define MAILBOX_CONSOLE 0
 #define EXIT_CODE 0xfffffff0
 #define EXIT_OK 0
 #define EXIT_FAIL 1
+#define SIM_MARKER 0xf2
 
 #define READ_REG32(addr) (*((volatile uint32_t*)addr))
 #define WRITE_REG32(addr, data) (*((volatile uint32_t*)addr) = data)
@@ -14,3 +20,5 @@
 void sim_exit(uint32_t code);
 void sim_send_ch(char ch);
 void sim_send_str(const char* const str);
+void sim_marker(void);
+void sim_send_block(uint8_t ch, const void* data, uint32_t size);
@@ -17,6 +17,18 @@ Original Author: Shay Gal-on
 */
 #include "coremark.h"
 #include "core_portme.h"
+#include "sim.h"
+#if HPM
+#include "hpm.h"
+#if HPM == 2
+// branch predictor, "make hpm=btb"
+#define HPM_EVENTS  HPM_EV_BTB_HIT, HPM_EV_BTB_MISS, HPM_EV_BTB_LOST, HPM_EV_FLUSH
+#define HPM_NAMES   "btb hit", "btb miss", "btb lost", "flush"
+#else
+#define HPM_EVENTS  HPM_EV_FETCH_EMPTY, HPM_EV_DATA_STALL, HPM_EV_MULDIV_BUSY, HPM_EV_FLUSH
+#define HPM_NAMES   "fetch empty", "data stall", "mul/div busy", "flush"
+#endif
+#endif
 
 #if VALIDATION_RUN
 volatile ee_s32 seed1_volatile = 0x3415;
@@ -88,6 +100,12 @@ static CORETIMETYPE start_time_val, stop_time_val;
 void
 start_time(void)
 {
+#ifdef SIM
+    sim_marker();
+#endif
+#if HPM
+    hpm_start(HPM_EVENTS);
+#endif
     GETMYTIME(&start_time_val);
 }
 /* Function : stop_time
@@ -102,6 +120,12 @@ void
 stop_time(void)
 {
     GETMYTIME(&stop_time_val);
+#if HPM
+    hpm_stop();
+#endif
+#ifdef SIM
+    sim_marker();
+#endif
 }
 /* Function : get_time
         Return an abstract "ticks" number that signifies time on the system.
@@ -165,6 +189,16 @@ void
 portable_fini(core_portable *p)
 {
     p->portable_id = 0;
+#if HPM
+    static const char* const hpm_names[HPM_COUNTERS] = { HPM_NAMES };
+    for (ee_u32 i=0 ; i<HPM_COUNTERS ; ++i)
+    {
+        // ee_printf has no 64-bit conversions, printed as two hex halves
+        ee_u64 cnt = hpm_read(HPM_FIRST + i);
+        ee_printf("HPM %-12s : 0x%08lx%08lx\n", hpm_names[i], (unsigned long)(cnt >> 32),
+                  (unsigned long)(ee_u32)cnt);
+    }
+#endif
     sim_exit(EXIT_OK);
     while (1);
 }
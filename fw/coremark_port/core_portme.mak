@@ -5,6 +5,13 @@ PROJ_NAME = coremark
 OBJS = init.o uart.o sim.o core_portme.o ee_printf.o core_list_join.o core_main.o core_matrix.o core_state.o core_util.o
 C_FLAGS = -I$(PORT_DIR) -I../coremark/ -I../common/ -DHZ=75000000 -DITERATIONS=1200
 C_FLAGS += -DPERFORMANCE_RUN=1
+# Zihpm counters over the timed region (fw/common/hpm.h), e.g. "make hpm=1",
+# "make hpm=btb" counts the branch predictor events
+ifeq ($(hpm),btb)
+	C_FLAGS += -DHPM=2
+else ifneq ($(hpm),)
+	C_FLAGS += -DHPM=1
+endif
 WORK_DIR = $(PORT_DIR)/out
 OPATH = $(WORK_DIR)
 
@@ -171,6 +171,9 @@ int main ()
   /* Start timer */
   /***************/
  
+#ifdef SIM
+  sim_marker();
+#endif
 #ifdef TIMES
   //times (&time_info);
   Begin_Time = _times();//(long) time_info.tms_utime;
@@ -241,6 +244,9 @@ int main ()
 #endif
 #ifdef CLOCK
   End_Time = clock();
+#endif
+#ifdef SIM
+  sim_marker();
 #endif
   xprintf("Execution ends\n");
   xprintf("\n");
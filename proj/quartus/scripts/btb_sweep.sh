@@ -0,0 +1,22 @@
+#!/bin/sh
+# Logic elements and Fmax per branch target buffer, a full build for each:
+# "none" - no branch prediction, 0 - fully associative (8 entries), 1/2/4 - indexed,
+# 64 entries of that many ways. Reports are kept in output_btb_<ways>.
+# Usage: scripts/btb_sweep.sh <ways...> (from proj/quartus)
+
+for w in "$@"
+do
+    case $w in
+        none) PARAMS="BRANCH_PREDICTION=0" ;;
+        0) PARAMS="BRANCH_PREDICTION=1 BRANCH_TABLE_SIZE_BITS=3 BRANCH_TABLE_WAYS=0" ;;
+        *) PARAMS="BRANCH_PREDICTION=1 BRANCH_TABLE_SIZE_BITS=6 BRANCH_TABLE_WAYS=$w" ;;
+    esac
+    make gparams="$PARAMS" > build_btb_$w.log 2>&1 || \
+        { echo "ways=$w: build failed, see build_btb_$w.log"; continue; }
+    rm -rf output_btb_$w
+    cp -r output_files output_btb_$w
+    LES=$(grep "Total logic elements" output_btb_$w/riscv_soc.fit.summary | sed 's/.*: *//')
+    FMAX=$(grep -A4 "Slow 1200mV 85C Model Fmax Summary" output_btb_$w/riscv_soc.sta.rpt | \
+        grep -m1 "MHz" | awk -F';' '{ print $2 }')
+    echo "ways=$w: LEs $LES, Fmax$FMAX"
+done
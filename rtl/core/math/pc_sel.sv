@@ -1,5 +1,10 @@
 `timescale 1ps/1ps
 
+// Redirect of the fetch stage by a resolved jump/branch. A branch predicted taken
+// at the fetch stage (i_branch_pred) has been fetched from i_pc_pred already:
+//  taken to the predicted target   - no redirect
+//  taken to another target         - redirect to i_pc_target
+//  not taken (or not a branch)     - redirect to i_pc_next
 module pc_sel
 #(
     parameter int IADDR_SPACE_BITS      = 16,
@@ -10,21 +15,24 @@ module pc_sel
     input   wire                        i_branch_pred,
     input   wire                        i_inst_jal_jalr,
     input   wire                        i_inst_branch,
-    input   wire[IADDR_SPACE_BITS-1:1]  i_pc,
+    input   wire[IADDR_SPACE_BITS-1:1]  i_pc_pred,
     input   wire[IADDR_SPACE_BITS-1:1]  i_pc_next,
     input   wire[IADDR_SPACE_BITS-1:1]  i_pc_target,
     output  wire                        o_pc_select,
+    output  wire                        o_taken,
     output  wire[IADDR_SPACE_BITS-1:1]  o_pc_target
 );
 
-    logic       pc_select, pred_ok;
+    logic       pc_select, taken, pred, pred_ok;
     logic[IADDR_SPACE_BITS-1:1] pc_out;
-    assign      pred_ok = (i_pc_target == i_pc);
-    assign      pc_select = (i_inst_jal_jalr | (i_inst_branch & (i_cmp))) ^
-                            (i_branch_pred & pred_ok & BRANCH_PREDICTION);
-    assign      pc_out = (i_branch_pred & pred_ok) ? i_pc_next : i_pc_target;
+    assign      taken = i_inst_jal_jalr | (i_inst_branch & i_cmp);
+    assign      pred = i_branch_pred & BRANCH_PREDICTION;
+    assign      pred_ok = taken & (i_pc_target == i_pc_pred);
+    assign      pc_select = pred ? !pred_ok : taken;
+    assign      pc_out = (pred & !taken) ? i_pc_next : i_pc_target;
 
     assign  o_pc_select = pc_select;
+    assign  o_taken = taken;
     assign  o_pc_target = pc_out;
 
 endmodule
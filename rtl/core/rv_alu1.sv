@@ -5,7 +5,8 @@
 
 module rv_alu1
 #(
-    parameter int IADDR_SPACE_BITS      = 16
+    parameter int IADDR_SPACE_BITS      = 16,
+    parameter int BRANCH_BHT_SIZE_BITS  = 6
 )
 (
     input   wire                        i_clk,
@@ -14,6 +15,9 @@ module rv_alu1
     input   wire                        i_stall,
     input   wire[IADDR_SPACE_BITS-1:1]  i_pc,
     input   wire[IADDR_SPACE_BITS-1:1]  i_pc_next,
+    input   wire                        i_pred,
+    input   wire[IADDR_SPACE_BITS-1:1]  i_pred_target,
+    input   wire[BRANCH_BHT_SIZE_BITS-1:0] i_pred_idx,
     input   wire[4:0]                   i_rs1,
     input   wire[4:0]                   i_rs2,
     input   wire[4:0]                   i_rd,
@@ -45,6 +49,9 @@ module rv_alu1
     output  wire[IADDR_SPACE_BITS-1:1]  o_pc,
     output  wire[IADDR_SPACE_BITS-1:1]  o_pc_next,
     output  wire[IADDR_SPACE_BITS-1:1]  o_pc_target,
+    output  wire                        o_pred,
+    output  wire[IADDR_SPACE_BITS-1:1]  o_pred_target,
+    output  wire[BRANCH_BHT_SIZE_BITS-1:0] o_pred_idx,
     output  res_src_t                   o_res_src,
     output  wire[2:0]                   o_funct3,
     output  alu_ctrl_t                  o_alu_ctrl,
@@ -66,6 +73,9 @@ module rv_alu1
     logic       reg_write;
     logic[IADDR_SPACE_BITS-1:1] pc;
     logic[IADDR_SPACE_BITS-1:1] pc_next;
+    logic       pred;
+    logic[IADDR_SPACE_BITS-1:1] pred_target;
+    logic[BRANCH_BHT_SIZE_BITS-1:0] pred_idx;
     logic       to_trap;
 
     always_ff @(posedge i_clk)
@@ -82,6 +92,7 @@ module rv_alu1
             reg_write <= '0;
             res_src <= '0;
             inst_mret <= '0;
+            pred <= '0;
             to_trap <= '0;
             alu_ctrl <= '0;
         end
@@ -104,6 +115,9 @@ module rv_alu1
             store <= i_inst_store;
             pc <= i_pc;
             pc_next <= i_pc_next;
+            pred <= i_pred;
+            pred_target <= i_pred_target;
+            pred_idx <= i_pred_idx;
             to_trap <= i_to_trap;
         end
     end
@@ -150,6 +164,9 @@ module rv_alu1
     assign  o_pc = pc;
     assign  o_pc_next = pc_next;
     assign  o_pc_target = pc_target;
+    assign  o_pred = pred;
+    assign  o_pred_target = pred_target;
+    assign  o_pred_idx = pred_idx;
     assign  o_res_src = res_src;
     assign  o_funct3 = funct3;
     assign  o_alu_ctrl = alu_ctrl;
@@ -7,6 +7,7 @@ module rv_alu2
 #(
     parameter int IADDR_SPACE_BITS      = 16,
     parameter logic BRANCH_PREDICTION   = 0,
+    parameter int BRANCH_BHT_SIZE_BITS  = 6,
     parameter logic EXTENSION_Zicsr     = 1,
     parameter logic EXTENSION_M         = 1
 )
@@ -25,6 +26,9 @@ module rv_alu2
     input   wire[IADDR_SPACE_BITS-1:1]  i_pc,
     input   wire[IADDR_SPACE_BITS-1:1]  i_pc_next,
     input   wire[IADDR_SPACE_BITS-1:1]  i_pc_target,
+    input   wire                        i_pred,
+    input   wire[IADDR_SPACE_BITS-1:1]  i_pred_target,
+    input   wire[BRANCH_BHT_SIZE_BITS-1:0] i_pred_idx,
     input   res_src_t                   i_res_src,
     input   wire[2:0]                   i_funct3,
     input   alu_ctrl_t                  i_alu_ctrl,
@@ -47,6 +51,15 @@ module rv_alu2
     output  wire[2:0]                   o_funct3,
     output  wire                        o_to_trap,
     output  wire                        o_instr_jal_jalr_branch,
+    // resolved jump/branch for the branch predictor
+    output  wire                        o_bp_update,
+    output  wire                        o_bp_jump,
+    output  wire                        o_bp_taken,
+    output  wire                        o_bp_pred,
+    output  wire                        o_bp_remove,
+    output  wire[BRANCH_BHT_SIZE_BITS-1:0] o_bp_idx,
+    output  wire[IADDR_SPACE_BITS-1:1]  o_bp_pc,
+    output  wire[IADDR_SPACE_BITS-1:1]  o_bp_target,
     output  wire                        o_ready
 );
 
@@ -58,6 +71,9 @@ module rv_alu2
     logic[IADDR_SPACE_BITS-1:1] pc;
     logic[IADDR_SPACE_BITS-1:1] pc_next;
     logic[IADDR_SPACE_BITS-1:1] pc_target;
+    logic       pred;
+    logic[IADDR_SPACE_BITS-1:1] pred_target;
+    logic[BRANCH_BHT_SIZE_BITS-1:0] pred_idx;
     res_src_t   res_src;
     logic[2:0]  funct3;
     alu_ctrl_t  alu_ctrl;
@@ -123,6 +139,7 @@ module rv_alu2
             rd <= '0;
             inst_jal_jalr <= '0;
             inst_branch <= '0;
+            pred <= '0;
             store <= '0;
             reg_write <= '0;
             res_src <= '0;
@@ -140,6 +157,9 @@ module rv_alu2
             pc <= i_pc;
             pc_next <= i_pc_next;
             pc_target <= i_pc_target;
+            pred <= i_pred;
+            pred_target <= i_pred_target;
+            pred_idx <= i_pred_idx;
             res_src <= i_res_src;
             funct3 <= i_funct3;
             alu_ctrl <= i_alu_ctrl;
@@ -213,6 +233,7 @@ module rv_alu2
     end
 
     logic pc_select;
+    logic taken;
 
     pc_sel
     #(
@@ -222,18 +243,29 @@ module rv_alu2
     u_pc_sel
     (
         .i_cmp                          (cmp_result),
-        .i_branch_pred                  ('0),
+        .i_branch_pred                  (pred),
         .i_inst_jal_jalr                (inst_jal_jalr),
         .i_inst_branch                  (inst_branch),
-        .i_pc                           (pc),
+        .i_pc_pred                      (pred_target),
         .i_pc_next                      (pc_next),
         .i_pc_target                    (pc_target),
         .o_pc_select                    (pc_select),
+        .o_taken                        (taken),
         .o_pc_target                    (o_pc_target)
     );
 
     assign o_pc_select = pc_select & !i_flush;
 
+    assign o_bp_update = instr_jal_jalr_branch & !i_flush;
+    assign o_bp_jump = inst_jal_jalr;
+    assign o_bp_taken = taken;
+    assign o_bp_pred = pred & !i_flush;
+    // a non-branch predicted by a partial tag alias, its BTB entry is removed
+    assign o_bp_remove = pred & !instr_jal_jalr_branch & !i_flush;
+    assign o_bp_idx = pred_idx;
+    assign o_bp_pc = pc;
+    assign o_bp_target = pc_target;
+
     logic[63:0] mul;
     logic[31:0] div, rem;
     logic       md_op2;
@@ -14,6 +14,10 @@ module rv_core
     parameter int IADDR_SPACE_BITS      = 16,
     parameter logic BRANCH_PREDICTION   = 0,
     parameter int BRANCH_TABLE_SIZE_BITS= 2,
+    parameter int BRANCH_TABLE_WAYS     = 0,
+    parameter int BRANCH_TAG_BITS       = 8,
+    parameter int BRANCH_BHT_SIZE_BITS  = 6, // direction counters, 2**N
+    parameter int BRANCH_GHR_BITS       = 0, // global history of gshare, 0 - bimodal
     parameter int INSTR_BUF_ADDR_SIZE   = 2, // buffer size is 2**N words (32 bit)
     parameter logic ALU2_ISOLATED       = 0,
     parameter logic EXTENSION_C         = 1,
@@ -57,7 +61,9 @@ module rv_core
     output  wire[3:0]                   o_data_sel,
     input   wire                        i_data_ack,
     input   wire[31:0]                  i_data_rdata,
-    output  wire                        o_instr_issued
+    output  wire                        o_instr_issued,
+    // performance events, `HPM_EV_*
+    output  wire[`HPM_EVENTS-1:0]       o_hpm_events
 );
 
     logic[31:0] reg_rdata1, reg_rdata2;
@@ -69,6 +75,18 @@ module rv_core
     logic       alu2_pc_select;
     logic       fetch_pc_change;
     logic[IADDR_SPACE_BITS-1:1] alu2_pc_target;
+    logic       fetch_pred;
+    logic[IADDR_SPACE_BITS-1:1] fetch_pred_target;
+    logic[BRANCH_BHT_SIZE_BITS-1:0] fetch_pred_idx;
+    logic       fetch_pred_lost;
+    logic       alu2_bp_update;
+    logic       alu2_bp_jump;
+    logic       alu2_bp_taken;
+    logic       alu2_bp_pred;
+    logic       alu2_bp_remove;
+    logic[BRANCH_BHT_SIZE_BITS-1:0] alu2_bp_idx;
+    logic[IADDR_SPACE_BITS-1:1] alu2_bp_pc;
+    logic[IADDR_SPACE_BITS-1:1] alu2_bp_target;
 
 `ifdef USE_SCHEMATIC
 /* verilator lint_off UNUSEDSIGNAL */
@@ -99,6 +117,10 @@ module rv_core
         .o_pc_next                      (fetch_pc_next),
         .o_ready                        (fetch_ready)
     );
+    assign  fetch_pred = '0;
+    assign  fetch_pred_target = '0;
+    assign  fetch_pred_idx = '0;
+    assign  fetch_pred_lost = '0;
 `else
     logic[IADDR_SPACE_BITS-1:1] fetch_pc;
     logic[IADDR_SPACE_BITS-1:1] fetch_pc_next;
@@ -106,9 +128,15 @@ module rv_core
     #(
         .RESET_ADDR                     (RESET_ADDR),
         .IADDR_SPACE_BITS               (IADDR_SPACE_BITS),
+        .BRANCH_PREDICTION              (BRANCH_PREDICTION),
+        .BRANCH_TABLE_SIZE_BITS         (BRANCH_TABLE_SIZE_BITS),
+        .BRANCH_TABLE_WAYS              (BRANCH_TABLE_WAYS),
+        .BRANCH_TAG_BITS                (BRANCH_TAG_BITS),
+        .BRANCH_BHT_SIZE_BITS           (BRANCH_BHT_SIZE_BITS),
+        .BRANCH_GHR_BITS                (BRANCH_GHR_BITS),
         .INSTR_BUF_ADDR_SIZE            (INSTR_BUF_ADDR_SIZE),
         .ALU2_ISOLATED                  (ALU2_ISOLATED),
-        //.EXTENSION_C                    (EXTENSION_C),
+        .EXTENSION_C                    (EXTENSION_C),
         .EXTENSION_Zicsr                (EXTENSION_Zicsr)
     )
     u_st1_fetch
@@ -122,12 +150,23 @@ module rv_core
         .i_ebreak                       (alu2_to_trap),
         .i_instruction                  (i_instr_data),
         .i_ack                          (i_instr_ack),
+        .i_bp_update                    (alu2_bp_update),
+        .i_bp_jump                      (alu2_bp_jump),
+        .i_bp_taken                     (alu2_bp_taken),
+        .i_bp_remove                    (alu2_bp_remove),
+        .i_bp_idx                       (alu2_bp_idx),
+        .i_bp_pc                        (alu2_bp_pc),
+        .i_bp_target                    (alu2_bp_target),
         .o_pc_change                    (fetch_pc_change),
         .o_addr                         (o_instr_addr),
         .o_cyc                          (o_instr_req),
         .o_instruction                  (fetch_instruction),
         .o_pc                           (fetch_pc),
         .o_pc_next                      (fetch_pc_next),
+        .o_pred                         (fetch_pred),
+        .o_pred_target                  (fetch_pred_target),
+        .o_pred_idx                     (fetch_pred_idx),
+        .o_pred_lost                    (fetch_pred_lost),
         .o_ready                        (fetch_ready)
     );
 `endif
@@ -154,6 +193,9 @@ module rv_core
     logic[31:0] decode_instr;
 `endif
     logic       decode_to_trap;
+    logic       decode_pred;
+    logic[IADDR_SPACE_BITS-1:1] decode_pred_target;
+    logic[BRANCH_BHT_SIZE_BITS-1:0] decode_pred_idx;
 
 `ifdef USE_SCHEMATIC
 /* verilator lint_off UNUSEDSIGNAL */
@@ -200,6 +242,9 @@ module rv_core
   `ifdef TO_SIM
     assign decode_instr = '0;
   `endif
+    assign decode_pred = '0;
+    assign decode_pred_target = '0;
+    assign decode_pred_idx = '0;
 `else
     logic[IADDR_SPACE_BITS-1:1] decode_pc;
     logic[IADDR_SPACE_BITS-1:1] decode_pc_next;
@@ -209,6 +254,7 @@ module rv_core
         .IADDR_SPACE_BITS               (IADDR_SPACE_BITS),
         .BRANCH_PREDICTION              (BRANCH_PREDICTION),
         .BRANCH_TABLE_SIZE_BITS         (BRANCH_TABLE_SIZE_BITS),
+        .BRANCH_BHT_SIZE_BITS           (BRANCH_BHT_SIZE_BITS),
         .EXTENSION_C                    (EXTENSION_C),
         .EXTENSION_F                    (EXTENSION_F),
         .EXTENSION_M                    (EXTENSION_M),
@@ -224,6 +270,9 @@ module rv_core
         .i_ready                        (fetch_ready),
         .i_pc                           (fetch_pc),
         .i_pc_next                      (fetch_pc_next),
+        .i_pred                         (fetch_pred),
+        .i_pred_target                  (fetch_pred_target),
+        .i_pred_idx                     (fetch_pred_idx),
 `ifdef TO_SIM
         .o_instr                        (decode_instr),
 `endif
@@ -236,6 +285,9 @@ module rv_core
         .o_csr_ebreak                   (o_csr_ebreak),
         .o_pc                           (decode_pc),
         .o_pc_next                      (decode_pc_next),
+        .o_pred                         (decode_pred),
+        .o_pred_target                  (decode_pred_target),
+        .o_pred_idx                     (decode_pred_idx),
         .o_rs1                          (decode_rs1),
         .o_rs2                          (decode_rs2),
         .o_rd                           (decode_rd),
@@ -308,6 +360,9 @@ module rv_core
     logic[IADDR_SPACE_BITS-1:1] alu1_pc;
     logic[IADDR_SPACE_BITS-1:1] alu1_pc_next;
     logic[IADDR_SPACE_BITS-1:1] alu1_pc_target;
+    logic       alu1_pred;
+    logic[IADDR_SPACE_BITS-1:1] alu1_pred_target;
+    logic[BRANCH_BHT_SIZE_BITS-1:0] alu1_pred_idx;
     res_src_t   alu1_res_src;
     logic[2:0]  alu1_funct3;
     alu_ctrl_t  alu1_alu_ctrl;
@@ -317,7 +372,8 @@ module rv_core
 
     rv_alu1
     #(
-        .IADDR_SPACE_BITS               (IADDR_SPACE_BITS)
+        .IADDR_SPACE_BITS               (IADDR_SPACE_BITS),
+        .BRANCH_BHT_SIZE_BITS           (BRANCH_BHT_SIZE_BITS)
     )
     u_st3_alu1
     (
@@ -327,6 +383,9 @@ module rv_core
         .i_stall                        (alu1_stall),
         .i_pc                           (decode_pc[IADDR_SPACE_BITS-1:1]),
         .i_pc_next                      (decode_pc_next[IADDR_SPACE_BITS-1:1]),
+        .i_pred                         (decode_pred),
+        .i_pred_target                  (decode_pred_target),
+        .i_pred_idx                     (decode_pred_idx),
         .i_rs1                          (decode_rs1),
         .i_rs2                          (decode_rs2),
         .i_rd                           (decode_rd),
@@ -358,6 +417,9 @@ module rv_core
         .o_pc                           (alu1_pc),
         .o_pc_next                      (alu1_pc_next),
         .o_pc_target                    (alu1_pc_target),
+        .o_pred                         (alu1_pred),
+        .o_pred_target                  (alu1_pred_target),
+        .o_pred_idx                     (alu1_pred_idx),
         .o_res_src                      (alu1_res_src),
         .o_funct3                       (alu1_funct3),
         .o_alu_ctrl                     (alu1_alu_ctrl),
@@ -379,6 +441,7 @@ module rv_core
     #(
         .IADDR_SPACE_BITS               (IADDR_SPACE_BITS),
         .BRANCH_PREDICTION              (BRANCH_PREDICTION),
+        .BRANCH_BHT_SIZE_BITS           (BRANCH_BHT_SIZE_BITS),
         .EXTENSION_Zicsr                (EXTENSION_Zicsr),
         .EXTENSION_M                    (EXTENSION_M)
     )
@@ -398,6 +461,9 @@ module rv_core
         .i_pc                           (alu1_pc),
         .i_pc_next                      (alu1_pc_next),
         .i_pc_target                    (alu1_pc_target),
+        .i_pred                         (alu1_pred),
+        .i_pred_target                  (alu1_pred_target),
+        .i_pred_idx                     (alu1_pred_idx),
         .i_res_src                      (alu1_res_src),
         .i_funct3                       (alu1_funct3),
         .i_alu_ctrl                     (alu1_alu_ctrl),
@@ -419,6 +485,14 @@ module rv_core
         .o_wsel                         (o_data_sel),
         .o_funct3                       (alu2_funct3),
         .o_instr_jal_jalr_branch        (alu2_instr_jal_jalr_branch),
+        .o_bp_update                    (alu2_bp_update),
+        .o_bp_jump                      (alu2_bp_jump),
+        .o_bp_taken                     (alu2_bp_taken),
+        .o_bp_pred                      (alu2_bp_pred),
+        .o_bp_remove                    (alu2_bp_remove),
+        .o_bp_idx                       (alu2_bp_idx),
+        .o_bp_pc                        (alu2_bp_pc),
+        .o_bp_target                    (alu2_bp_target),
         .o_to_trap                      (alu2_to_trap),
         .o_ready                        (alu2_ready)
     );
@@ -469,6 +543,7 @@ module rv_core
     );
 
     logic   inv_inst;
+    logic   ctrl_data_stall;
     logic   ctrl_need_pause;
     assign  ctrl_need_pause = o_csr_read &
                               (alu1_inst_jal_jalr | alu1_inst_branch | alu2_instr_jal_jalr_branch);
@@ -500,6 +575,7 @@ module rv_core
         .o_alu2_stall                   (alu2_stall),
         .o_write_flush                  (write_flush),
         .o_write_stall                  (write_stall),
+        .o_data_stall                   (ctrl_data_stall),
         .o_inv_inst                     (inv_inst)
     );
 
@@ -529,6 +605,7 @@ module rv_core
         .i_exec_stall                   (alu1_stall),
         .i_write_flush                  (write_flush),
         .i_write_stall                  (write_stall),
+        .i_trap                         (alu2_to_trap),
         .o_rd                           (trace_rd),
         .i_rd                           (trace_rd_data)
     );
@@ -547,9 +624,37 @@ module rv_core
     assign  o_instr_issued = (data_req | alu2_reg_write);
     assign  o_reg_rdata1 = dh_data1;
 
+    logic[`HPM_EVENTS-1:0]  hpm_events;
+    always_comb
+    begin
+        hpm_events = '0;
+        hpm_events[`HPM_EV_FETCH_EMPTY] = !fetch_ready;
+        hpm_events[`HPM_EV_DATA_STALL] = ctrl_data_stall;
+        hpm_events[`HPM_EV_MULDIV_BUSY] = !alu2_ready;
+        hpm_events[`HPM_EV_FLUSH] = fetch_pc_change;
+        // jump/branch taken as predicted, otherwise a redirect by alu2
+        hpm_events[`HPM_EV_BTB_HIT] = alu2_bp_pred & !alu2_pc_select;
+        hpm_events[`HPM_EV_BTB_MISS] = alu2_pc_select;
+        hpm_events[`HPM_EV_BTB_LOST] = fetch_pred_lost;
+    end
+    assign  o_hpm_events = hpm_events;
+
 `ifdef TO_SIM
     assign  o_debug[0] = inv_inst;
-    assign  o_debug[31:1] = '0;
+    // data access on the bus, fixed latency (vrf/sim_bus_delay.sv)
+    assign  o_debug[1] = data_req;
+    // pipeline state for the CPI stack of the harness (vrf/sim_cpi.h)
+    assign  o_debug[2] = decode_stall;
+    assign  o_debug[3] = alu1_stall;
+    assign  o_debug[4] = alu1_flush;
+    assign  o_debug[5] = alu2_flush;
+    assign  o_debug[6] = fetch_ready;
+    assign  o_debug[7] = !alu2_ready;
+    assign  o_debug[8] = ctrl_data_stall;
+    assign  o_debug[9] = fetch_pc_change;
+    assign  o_debug[10] = o_instr_issued;
+    // 11 - bus conflict, rv_top_wb
+    assign  o_debug[31:11] = '0;
 `endif
 
 /* verilator lint_off UNUSEDSIGNAL */
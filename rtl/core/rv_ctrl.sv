@@ -30,6 +30,7 @@ module rv_ctrl
     output  wire                        o_alu2_stall,
     output  wire                        o_write_flush,
     output  wire                        o_write_stall,
+    output  wire                        o_data_stall,
     output  wire                        o_inv_inst
 );
 /* verilator lint_on UNUSEDSIGNAL */
@@ -82,6 +83,7 @@ module rv_ctrl
     assign  o_alu2_stall  = alu2_stall;
     assign  o_write_flush = write_flush;
     assign  o_write_stall = write_stall;
+    assign  o_data_stall  = |need_mem_data;
 
     assign  o_inv_inst = !inst_sup[1];
 
@@ -10,6 +10,7 @@ module rv_decode
     parameter int IADDR_SPACE_BITS      = 16,
     parameter logic BRANCH_PREDICTION   = 0,
     parameter int BRANCH_TABLE_SIZE_BITS= 2,
+    parameter int BRANCH_BHT_SIZE_BITS  = 6,
     parameter logic EXTENSION_C         = 1,
     parameter logic EXTENSION_F         = 0,
     parameter logic EXTENSION_M         = 1,
@@ -24,6 +25,10 @@ module rv_decode
     input   wire                        i_ready,
     input   wire[IADDR_SPACE_BITS-1:1]  i_pc,
     input   wire[IADDR_SPACE_BITS-1:1]  i_pc_next,
+    // branch prediction of the fetch stage
+    input   wire                        i_pred,
+    input   wire[IADDR_SPACE_BITS-1:1]  i_pred_target,
+    input   wire[BRANCH_BHT_SIZE_BITS-1:0] i_pred_idx,
 `ifdef TO_SIM
     output  wire[31:0]                  o_instr,
 `endif
@@ -37,6 +42,9 @@ module rv_decode
     output  wire                        o_csr_ebreak,
     output  wire[IADDR_SPACE_BITS-1:1]  o_pc,
     output  wire[IADDR_SPACE_BITS-1:1]  o_pc_next,
+    output  wire                        o_pred,
+    output  wire[IADDR_SPACE_BITS-1:1]  o_pred_target,
+    output  wire[BRANCH_BHT_SIZE_BITS-1:0] o_pred_idx,
     output  wire[4:0]                   o_rs1,
     output  wire[4:0]                   o_rs2,
     output  wire[4:0]                   o_rd,
@@ -62,6 +70,9 @@ module rv_decode
     logic[31:0] instruction;
     logic[IADDR_SPACE_BITS-1:1] pc;
     logic[IADDR_SPACE_BITS-1:1] pc_next;
+    logic                       pred;
+    logic[IADDR_SPACE_BITS-1:1] pred_target;
+    logic[BRANCH_BHT_SIZE_BITS-1:0] pred_idx;
 
     assign  instruction_c = i_ready ? i_instruction : '0;
     generate
@@ -85,6 +96,7 @@ module rv_decode
                     begin
                         instruction   <= '0;
                         valid_input   <= '0;
+                        pred          <= '0;
                     end
                     else if (!i_stall)
                     begin
@@ -92,6 +104,9 @@ module rv_decode
                         valid_input   <= i_ready;
                         pc <= i_pc;
                         pc_next <= i_pc_next;
+                        pred <= i_pred & i_ready;
+                        pred_target <= i_pred_target;
+                        pred_idx <= i_pred_idx;
                     end
                 end
             end
@@ -100,6 +115,9 @@ module rv_decode
                 assign instruction = instruction_unc;
                 assign pc = i_pc;
                 assign pc_next = i_pc_next;
+                assign pred = i_pred & i_ready;
+                assign pred_target = i_pred_target;
+                assign pred_idx = i_pred_idx;
                 assign valid_input = !i_stall & i_ready;
             end
         end
@@ -108,6 +126,9 @@ module rv_decode
             assign instruction = instruction_c;
             assign pc = i_pc;
             assign pc_next = i_pc_next;
+            assign pred = i_pred & i_ready;
+            assign pred_target = i_pred_target;
+            assign pred_idx = i_pred_idx;
             assign valid_input = !i_flush & i_ready;
         end
     endgenerate
@@ -292,6 +313,9 @@ module rv_decode
     assign  o_inst_branch     = (op == RV32_OPC_BRANCH);
     assign  o_inst_store      = inst_store;
     assign  o_pc_next         = pc_next;
+    assign  o_pred            = pred;
+    assign  o_pred_target     = pred_target;
+    assign  o_pred_idx        = pred_idx;
 `ifdef TO_SIM
     assign  o_instr        = instruction;
 `endif
@@ -6,11 +6,18 @@ module rv_fetch
 #(
     parameter logic[31:0]  RESET_ADDR   = 32'h0000_0000,
     parameter int IADDR_SPACE_BITS      = 16,
+    parameter logic BRANCH_PREDICTION   = 0,
+    parameter int BRANCH_TABLE_SIZE_BITS= 2,
+    parameter int BRANCH_TABLE_WAYS     = 0,
+    parameter int BRANCH_TAG_BITS       = 8,
+    parameter int BRANCH_BHT_SIZE_BITS  = 6,
+    parameter int BRANCH_GHR_BITS       = 0,
     parameter int INSTR_BUF_ADDR_SIZE   = 2,
     parameter logic ALU2_ISOLATED       = 0,
-    //parameter logic EXTENSION_C         = 1,
+    parameter logic EXTENSION_C         = 1,
     parameter logic EXTENSION_Zicsr     = 1
 )
+/* verilator lint_off UNUSEDSIGNAL */
 (
     input   wire                        i_clk,
     input   wire                        i_reset_n,
@@ -21,20 +28,42 @@ module rv_fetch
     input   wire                        i_ebreak,
     input   wire[31:0]                  i_instruction,
     input   wire                        i_ack,
+    // resolved jump/branch (rv_alu2)
+    input   wire                        i_bp_update,
+    input   wire                        i_bp_jump,
+    input   wire                        i_bp_taken,
+    input   wire                        i_bp_remove,
+    input   wire[BRANCH_BHT_SIZE_BITS-1:0] i_bp_idx,
+    input   wire[IADDR_SPACE_BITS-1:1]  i_bp_pc,
+    input   wire[IADDR_SPACE_BITS-1:1]  i_bp_target,
     output  wire                        o_pc_change,
     output  wire[IADDR_SPACE_BITS-1:1]  o_addr,
     output  wire                        o_cyc,
     output  wire[31:0]                  o_instruction,
     output  wire[IADDR_SPACE_BITS-1:1]  o_pc,
     output  wire[IADDR_SPACE_BITS-1:1]  o_pc_next,
+    output  wire                        o_pred,
+    output  wire[IADDR_SPACE_BITS-1:1]  o_pred_target,
+    output  wire[BRANCH_BHT_SIZE_BITS-1:0] o_pred_idx,
+    output  wire                        o_pred_lost,
     output  wire                        o_ready
 );
+/* verilator lint_on UNUSEDSIGNAL */
 
     logic       not_full;
 
     logic[IADDR_SPACE_BITS-1:1] pc;
     logic[IADDR_SPACE_BITS-1:1] pc_next;
+/* verilator lint_off UNUSEDSIGNAL */
+    logic[IADDR_SPACE_BITS-1:1] pc_lookup;
+/* verilator lint_on UNUSEDSIGNAL */
     logic                       change_pc;
+    logic                       pred_change;
+    logic                       pred;
+    logic                       pred_select;
+    logic[IADDR_SPACE_BITS-1:1] pred_target;
+    logic[BRANCH_BHT_SIZE_BITS-1:0] pred_idx;
+    logic                       lookup_lost;
 
     rv_fetch_addr
     #(
@@ -52,9 +81,12 @@ module rv_fetch
         .i_pc_select                    (i_pc_select),
         .i_pc_trap                      (i_pc_trap),
         .i_ebreak                       (i_ebreak),
+        .i_pred_select                  (pred_select),
+        .i_pred_target                  (pred_target),
         .o_pc                           (pc),
         .o_pc_next                      (pc_next),
-        .o_change_pc                    (change_pc)
+        .o_change_pc                    (change_pc),
+        .o_pred_change                  (pred_change)
     );
 
     logic   push_next, push;
@@ -68,7 +100,7 @@ module rv_fetch
     end
 
     // buffer reset logic
-    assign  buf_reset_n = !(!i_reset_n | change_pc);
+    assign  buf_reset_n = !(!i_reset_n | change_pc | pred_change);
 
     rv_fetch_buf
     #(
@@ -88,11 +120,72 @@ module rv_fetch
         .o_data                 (o_instruction),
         .o_pc                   (o_pc),
         .o_pc_next              (o_pc_next),
+        .o_pc_lookup            (pc_lookup),
         .o_not_empty            (not_empty),
         .o_not_full             (not_full)
     );
 
+    // branch prediction for the instruction at the buffer head, a predicted jump
+    // redirects the fetch as it leaves the buffer. The head is a whole instruction,
+    // one straddling two fetch words is predicted once both halves are in, and a
+    // half-word target is entered the same way as after an alu2 redirect.
+    generate
+        if (BRANCH_PREDICTION)
+        begin : g_pred
+            logic                       predicted;
+/* verilator lint_off UNUSEDSIGNAL */
+            logic[IADDR_SPACE_BITS-1:0] pc_new;
+/* verilator lint_on UNUSEDSIGNAL */
+
+            rv_fetch_branch_pred
+            #(
+                .IADDR_SPACE_BITS       (IADDR_SPACE_BITS),
+                .TABLE_SIZE_BITS        (BRANCH_TABLE_SIZE_BITS),
+                .TABLE_WAYS             (BRANCH_TABLE_WAYS),
+                .TAG_BITS               (BRANCH_TAG_BITS),
+                .BHT_SIZE_BITS          (BRANCH_BHT_SIZE_BITS),
+                .GHR_BITS               (BRANCH_GHR_BITS),
+                .EXTENSION_C            (EXTENSION_C)
+            )
+            u_pred
+            (
+                .i_clk                  (i_clk),
+                .i_reset_n              (i_reset_n),
+                .i_pc_lookup            ({ pc_lookup, 1'b0 }),
+                .i_pc_current           ({ o_pc, 1'b0 }),
+                .o_pc_new               (pc_new),
+                .o_pc_predicted         (predicted),
+                .o_bht_idx              (pred_idx),
+                .o_lookup_lost          (lookup_lost),
+                .i_update               (i_bp_update),
+                .i_jump                 (i_bp_jump),
+                .i_taken                (i_bp_taken),
+                .i_remove               (i_bp_remove),
+                .i_bht_idx              (i_bp_idx),
+                .i_pc_branch            ({ i_bp_pc, 1'b0 }),
+                .i_pc_target            ({ i_bp_target, 1'b0 })
+            );
+
+            assign  pred = predicted & not_empty;
+            assign  pred_target = pc_new[IADDR_SPACE_BITS-1:1];
+        end
+        else
+        begin : g_no_pred
+            assign  pred = '0;
+            assign  pred_target = '0;
+            assign  pred_idx = '0;
+            assign  lookup_lost = '0;
+        end
+    endgenerate
+
+    assign  pred_select = pred & !i_stall;
+
     assign  o_pc_change = change_pc;
+    assign  o_pred = pred;
+    assign  o_pred_target = pred_target;
+    assign  o_pred_idx = pred_idx;
+    // the head instruction leaves the buffer without a lookup
+    assign  o_pred_lost = lookup_lost & not_empty & !i_stall;
     assign  o_ready     = not_empty;
     // generate bus requests
     assign  o_cyc       = not_full;
@@ -17,9 +17,12 @@ module rv_fetch_addr
     input   wire                        i_pc_select,
     input   wire[IADDR_SPACE_BITS-1:1]  i_pc_trap,
     input   wire                        i_ebreak,
+    input   wire                        i_pred_select,
+    input   wire[IADDR_SPACE_BITS-1:1]  i_pred_target,
     output  wire[IADDR_SPACE_BITS-1:1]  o_pc,
     output  wire[IADDR_SPACE_BITS-1:1]  o_pc_next,
-    output  wire                        o_change_pc
+    output  wire                        o_change_pc,
+    output  wire                        o_pred_change
 );
 
     logic                       pc_select;
@@ -38,14 +41,31 @@ module rv_fetch_addr
     logic                       move_pc;
     logic                       change_pc;
     logic                       update_pc;
+    logic                       pred_change;
 
     logic       pc_next_trap_sel;
 
+`ifdef TO_SIM
+    // reset address can be moved by the simulation harness (fast-forward)
+    export "DPI-C" function fetch_set_reset_pc;
+
+    logic[IADDR_SPACE_BITS-1:1] reset_pc;
+
+    function void fetch_set_reset_pc(input int addr);
+        reset_pc = addr[IADDR_SPACE_BITS-1:1];
+    endfunction
+`else
+    wire[IADDR_SPACE_BITS-1:1]  reset_pc;
+    assign  reset_pc = RESET_ADDR[IADDR_SPACE_BITS-1:1];
+`endif
+
     // logic for change PC value (interrupts, jumps/branches, bus wait)
     assign  pc_next_trap_sel = i_ebreak & EXTENSION_Zicsr;
     assign  move_pc          = (i_ack & i_fifo_not_full);
     assign  change_pc        = pc_next_trap_sel | pc_select;
-    assign  update_pc        = (!i_reset_n) | change_pc | move_pc;
+    // predicted jump/branch leaving the fetch buffer, doesn't flush the pipeline
+    assign  pred_change      = i_pred_select & !change_pc;
+    assign  update_pc        = (!i_reset_n) | change_pc | pred_change | move_pc;
     assign  pc_incr          = { {(IADDR_SPACE_BITS-3){1'b0}}, !pc[1], pc[1] };
 
 /* verilator lint_off PINCONNECTEMPTY */
@@ -65,9 +85,10 @@ module rv_fetch_addr
 /* verilator lint_on  PINCONNECTEMPTY */
 
     // mux for PC pointer
-    assign  pc_next = (!i_reset_n) ? RESET_ADDR[IADDR_SPACE_BITS-1:1] :
+    assign  pc_next = (!i_reset_n) ? reset_pc :
                 pc_next_trap_sel ? i_pc_trap :
                 pc_select        ? pc_target :
+                pred_change      ? i_pred_target :
                 pc_sum;
 
     always_ff @(posedge i_clk)
@@ -79,10 +100,14 @@ module rv_fetch_addr
     assign  o_pc        = pc;
     assign  o_pc_next   = pc_next;
     assign  o_change_pc = change_pc;
+    assign  o_pred_change = pred_change;
 
 initial
 begin
     pc = '0;
+`ifdef TO_SIM
+    reset_pc = RESET_ADDR[IADDR_SPACE_BITS-1:1];
+`endif
 end
 
 endmodule
@@ -2,108 +2,236 @@
 
 `include "../rv_defines.vh"
 
+// Branch predictor of the fetch stage: a target table (BTB) and a table of 2-bit
+// saturating counters for the direction of conditional branches.
+// The target table is fully associative (TABLE_WAYS = 0), or an indexed RAM based
+// one (rv_fetch_btb, TABLE_WAYS = 1 - direct-mapped, 2/4/.. - set-associative) with
+// TAG_BITS partial tags, looked up a cycle ahead by i_pc_lookup.
+// Counters are indexed by the PC (bimodal) or by the PC xor the global history of
+// resolved branches (gshare, GHR_BITS > 0). Jumps are always predicted taken.
+// With the C extension branches are half-word aligned, so PC bit 1 is a part of
+// the counter index and the BTB set index.
+// The counter index of a lookup goes down the pipeline with the instruction and
+// comes back with the resolved branch, so the update hits the same counter.
 module rv_fetch_branch_pred
 #(
     parameter int IADDR_SPACE_BITS      = 32,
-    parameter int TABLE_SIZE_BITS       = 4
+    parameter int TABLE_SIZE_BITS       = 4,
+    parameter int TABLE_WAYS            = 0,
+    parameter int TAG_BITS              = 8,
+    parameter int BHT_SIZE_BITS         = 6,
+    parameter int GHR_BITS              = 0,
+    parameter logic EXTENSION_C         = 1
 )
+/* verilator lint_off UNUSEDSIGNAL */
 (
     input   wire                        i_clk,
     input   wire                        i_reset_n,
+    // lookup, i_pc_lookup is i_pc_current of the next cycle
+    input   wire[IADDR_SPACE_BITS-1:0]  i_pc_lookup,
     input   wire[IADDR_SPACE_BITS-1:0]  i_pc_current,
-    input   wire                        i_pc_select,
-    input   wire[IADDR_SPACE_BITS-1:0]  i_pc_branch,
-    input   wire[IADDR_SPACE_BITS-1:0]  i_pc_target,
     output  wire[IADDR_SPACE_BITS-1:0]  o_pc_new,
-    output  wire                        o_pc_predicted
+    output  wire                        o_pc_predicted,
+    output  wire[BHT_SIZE_BITS-1:0]     o_bht_idx,
+    // the lookup of this cycle is skipped by an update of the indexed table
+    output  wire                        o_lookup_lost,
+    // update by a resolved branch or jump
+    input   wire                        i_update,
+    input   wire                        i_jump,
+    input   wire                        i_taken,
+    // a predicted non-branch, only the indexed table aliases
+    input   wire                        i_remove,
+    input   wire[BHT_SIZE_BITS-1:0]     i_bht_idx,
+    input   wire[IADDR_SPACE_BITS-1:0]  i_pc_branch,
+    input   wire[IADDR_SPACE_BITS-1:0]  i_pc_target
 );
+/* verilator lint_on UNUSEDSIGNAL */
 
-    localparam int TABLE_SIZE = 2 ** TABLE_SIZE_BITS;
-    localparam int VALID_SIZE = TABLE_SIZE;
+    localparam int BHT_SIZE   = 2 ** BHT_SIZE_BITS;
+    localparam int BHT_LSB    = EXTENSION_C ? 1 : 2;
 
-    logic[IADDR_SPACE_BITS-1:0] tb_pc_cur[TABLE_SIZE];
-    logic[IADDR_SPACE_BITS-1:0] tb_pc_tar[TABLE_SIZE];
-    logic[(VALID_SIZE*TABLE_SIZE-1):0]  tb_valid;
+    // taken branches and jumps are stored into the target table
+    logic       insert;
+    assign  insert = i_update & i_taken;
 
-    logic[TABLE_SIZE_BITS-1:0]  tb_free_idx;
-    logic[TABLE_SIZE_BITS-1:0]  tb_same_idx;
-    logic[TABLE_SIZE_BITS-1:0]  tb_win_idx;
-    logic                       tb_win_valid;
-    logic[(TABLE_SIZE_BITS*TABLE_SIZE-1):0] tb_idx;
-    logic                       tb_is_update;
-    logic                       tb_have_same;
+    logic                       tb_hit;
+    logic                       tb_hit_jump;
+    logic[IADDR_SPACE_BITS-1:0] tb_target;
+    logic                       tb_lost;
 
     genvar i;
     generate
-        for (i=0 ; i<TABLE_SIZE ; i++)
-        begin : g_idx
-            assign tb_idx[(i * TABLE_SIZE_BITS)+:TABLE_SIZE_BITS] = i;
-        end
-    endgenerate
+        if (TABLE_WAYS == 0)
+        begin : g_full
+            localparam int TABLE_SIZE = 2 ** TABLE_SIZE_BITS;
+            localparam int VALID_SIZE = TABLE_SIZE;
+
+            logic[IADDR_SPACE_BITS-1:0] tb_pc_cur[TABLE_SIZE];
+            logic[IADDR_SPACE_BITS-1:0] tb_pc_tar[TABLE_SIZE];
+            logic                       tb_jump[TABLE_SIZE];
+            logic[(VALID_SIZE*TABLE_SIZE-1):0]  tb_valid;
+
+            logic[TABLE_SIZE_BITS-1:0]  tb_free_idx;
+            logic[TABLE_SIZE_BITS-1:0]  tb_same_idx;
+            logic[TABLE_SIZE_BITS-1:0]  tb_win_idx;
+            logic                       tb_win_valid;
+            logic[(TABLE_SIZE_BITS*TABLE_SIZE-1):0] tb_idx;
+            logic                       tb_is_update;
+            logic                       tb_have_same;
+
+            for (i=0 ; i<TABLE_SIZE ; i++)
+            begin : g_idx
+                assign tb_idx[(i * TABLE_SIZE_BITS)+:TABLE_SIZE_BITS] = i;
+            end
 
 /* verilator lint_off PINCONNECTEMPTY */
-    min_idx
-    #(
-        .ELEMENT_WIDTH                  (VALID_SIZE),
-        .INDEX_WIDTH                    (TABLE_SIZE_BITS),
-        .ELEMENT_COUNT                  (TABLE_SIZE)
-    )
-    u_min
-    (
-        .i_elements                     (tb_valid),
-        .i_idx                          (tb_idx),
-        .o_min_val                      (),
-        .o_min_idx                      (tb_free_idx)
-    );
+            min_idx
+            #(
+                .ELEMENT_WIDTH                  (VALID_SIZE),
+                .INDEX_WIDTH                    (TABLE_SIZE_BITS),
+                .ELEMENT_COUNT                  (TABLE_SIZE)
+            )
+            u_min
+            (
+                .i_elements                     (tb_valid),
+                .i_idx                          (tb_idx),
+                .o_min_val                      (),
+                .o_min_idx                      (tb_free_idx)
+            );
 /* verilator lint_on PINCONNECTEMPTY */
 
-    generate
-        for (i=0 ; i<TABLE_SIZE ; i++)
-        begin : g_btb
-            logic[(VALID_SIZE-1):0] valid_cur;
-            logic[(VALID_SIZE-2):0] valid_prev;
-            logic      have_entry;
-            logic      to_update;
-            logic      is_predicted;
+            for (i=0 ; i<TABLE_SIZE ; i++)
+            begin : g_btb
+                logic[(VALID_SIZE-1):0] valid_cur;
+                logic[(VALID_SIZE-2):0] valid_prev;
+                logic      have_entry;
+                logic      to_update;
+                logic      is_predicted;
 
-            assign valid_cur  = tb_valid[(i*VALID_SIZE)+:VALID_SIZE];
-            assign valid_prev = (i_pc_branch == tb_pc_cur[i]) ? valid_cur[VALID_SIZE-1:1] : '0;
+                assign valid_cur  = tb_valid[(i*VALID_SIZE)+:VALID_SIZE];
+                assign valid_prev = (i_pc_branch == tb_pc_cur[i]) ? valid_cur[VALID_SIZE-1:1] : '0;
 
-            always_ff @(posedge i_clk)
-            begin
-                if (!i_reset_n)
-                begin
-                    tb_pc_cur[i] <= '0;
-                    tb_pc_tar[i] <= '0;
-                    tb_valid[(i*VALID_SIZE)+:VALID_SIZE] <= '0;
-                end
-                else if (to_update)
+                always_ff @(posedge i_clk)
                 begin
-                    tb_pc_cur[i] <= i_pc_branch;
-                    tb_pc_tar[i] <= i_pc_target;
-                    tb_valid[(i*VALID_SIZE)+:VALID_SIZE] <= { 1'b1, valid_prev };
-                end
-                else if (tb_is_update)
-                begin
-                    tb_valid[(i*VALID_SIZE)+:VALID_SIZE] <= { 1'b0,
-                        tb_valid[(i*VALID_SIZE+1)+:(VALID_SIZE-1)] };
+                    if (!i_reset_n)
+                    begin
+                        tb_pc_cur[i] <= '0;
+                        tb_pc_tar[i] <= '0;
+                        tb_jump[i] <= '0;
+                        tb_valid[(i*VALID_SIZE)+:VALID_SIZE] <= '0;
+                    end
+                    else if (to_update)
+                    begin
+                        tb_pc_cur[i] <= i_pc_branch;
+                        tb_pc_tar[i] <= i_pc_target;
+                        tb_jump[i] <= i_jump;
+                        tb_valid[(i*VALID_SIZE)+:VALID_SIZE] <= { 1'b1, valid_prev };
+                    end
+                    else if (tb_is_update)
+                    begin
+                        tb_valid[(i*VALID_SIZE)+:VALID_SIZE] <= { 1'b0,
+                            tb_valid[(i*VALID_SIZE+1)+:(VALID_SIZE-1)] };
+                    end
                 end
+
+                assign to_update = ((i == tb_free_idx) & (!tb_have_same) & insert) |
+                    (insert & tb_have_same & (i == tb_same_idx));
+                assign is_predicted = ((|valid_cur) & (tb_pc_cur[i] == i_pc_current));
+                assign tb_is_update = (to_update & (tb_pc_tar[i] != i_pc_target)) ? '1 : 'z;
+                assign tb_win_idx = is_predicted ? i : 'z;
+                assign tb_win_valid = is_predicted ? '1 : 'z;
+
+                assign have_entry = ((|valid_cur) & (tb_pc_cur[i] == i_pc_branch));
+                assign tb_same_idx = have_entry ? i : 'z;
+                assign tb_have_same = have_entry ? '1 : 'z;
             end
 
-            assign to_update = ((i == tb_free_idx) & (!tb_have_same) & i_pc_select) |
-                (i_pc_select & tb_have_same & (i == tb_same_idx));
-            assign is_predicted = ((|valid_cur) & (tb_pc_cur[i] == i_pc_current));
-            assign tb_is_update = (to_update & (tb_pc_tar[i] != i_pc_target)) ? '1 : 'z;
-            assign tb_win_idx = is_predicted ? i : 'z;
-            assign tb_win_valid = is_predicted ? '1 : 'z;
+            assign tb_hit = tb_win_valid;
+            assign tb_lost = '0;
+            assign tb_hit_jump = tb_jump[tb_win_idx];
+            assign tb_target = tb_pc_tar[tb_win_idx];
+        end
+        else
+        begin : g_indexed
+            rv_fetch_btb
+            #(
+                .IADDR_SPACE_BITS               (IADDR_SPACE_BITS),
+                .TABLE_SIZE_BITS                (TABLE_SIZE_BITS),
+                .WAYS                           (TABLE_WAYS),
+                .TAG_BITS                       (TAG_BITS),
+                .EXTENSION_C                    (EXTENSION_C)
+            )
+            u_btb
+            (
+                .i_clk                          (i_clk),
+                .i_reset_n                      (i_reset_n),
+                .i_pc_lookup                    (i_pc_lookup[IADDR_SPACE_BITS-1:1]),
+                .i_pc_current                   (i_pc_current[IADDR_SPACE_BITS-1:1]),
+                .o_hit                          (tb_hit),
+                .o_jump                         (tb_hit_jump),
+                .o_pc_new                       (tb_target[IADDR_SPACE_BITS-1:1]),
+                .o_lost                         (tb_lost),
+                .i_insert                       (insert),
+                .i_remove                       (i_remove),
+                .i_jump                         (i_jump),
+                .i_pc_branch                    (i_pc_branch[IADDR_SPACE_BITS-1:1]),
+                .i_pc_target                    (i_pc_target[IADDR_SPACE_BITS-1:1])
+            );
 
-            assign have_entry = ((|valid_cur) & (tb_pc_cur[i] == i_pc_branch));
-            assign tb_same_idx = have_entry ? i : 'z;
-            assign tb_have_same = have_entry ? '1 : 'z;
+            assign tb_target[0] = 1'b0;
         end
     endgenerate
 
-    assign  o_pc_new = tb_pc_tar[tb_win_idx];
-    assign  o_pc_predicted = tb_win_valid;
+    // direction, 2-bit counters: 0,1 - not taken, 2,3 - taken
+    logic[1:0]                  bht[BHT_SIZE];
+    logic[BHT_SIZE_BITS-1:0]    bht_idx;
+    logic[1:0]                  bht_cur;
+    logic[1:0]                  bht_upd;
+
+    generate
+        if (GHR_BITS > 0)
+        begin : g_gshare
+            logic[GHR_BITS-1:0] ghr;
+
+            // history of resolved conditional branches, 1 - taken
+            always_ff @(posedge i_clk)
+            begin
+                if (!i_reset_n)
+                    ghr <= '0;
+                else if (i_update & !i_jump)
+                    ghr <= GHR_BITS'({ ghr, i_taken });
+            end
+
+            assign bht_idx = i_pc_current[BHT_LSB+:BHT_SIZE_BITS] ^ BHT_SIZE_BITS'(ghr);
+        end
+        else
+        begin : g_bimodal
+            assign bht_idx = i_pc_current[BHT_LSB+:BHT_SIZE_BITS];
+        end
+    endgenerate
+
+    assign  bht_cur = bht[bht_idx];
+    assign  bht_upd = bht[i_bht_idx];
+
+    always_ff @(posedge i_clk)
+    begin
+        if (!i_reset_n)
+        begin
+            for (int j=0 ; j<BHT_SIZE ; j++)
+                bht[j] <= 2'b01;
+        end
+        else if (i_update & !i_jump)
+        begin
+            if (i_taken & (bht_upd != 2'b11))
+                bht[i_bht_idx] <= bht_upd + 1'b1;
+            else if (!i_taken & (bht_upd != 2'b00))
+                bht[i_bht_idx] <= bht_upd - 1'b1;
+        end
+    end
+
+    assign  o_pc_new = tb_target;
+    assign  o_pc_predicted = tb_hit & (tb_hit_jump | bht_cur[1]);
+    assign  o_bht_idx = bht_idx;
+    assign  o_lookup_lost = tb_lost;
 
 endmodule
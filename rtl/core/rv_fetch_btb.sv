@@ -0,0 +1,197 @@
+`timescale 1ps/1ps
+
+// Indexed branch target buffer: direct-mapped (WAYS = 1) or WAYS-way set-associative,
+// 2**TABLE_SIZE_BITS entries with partial tags. Entries are RAMs with a registered
+// read address, so the lookup takes the address a cycle ahead (i_pc_lookup - the next
+// value of i_pc_current). Only valid bits and replacement pointers are flip-flops.
+// An insert reads its set in the first cycle and writes the hit way (or an invalid
+// one, or the round-robin victim) in the second one. A removal (a partial tag alias
+// predicted a non-branch instruction) reads the set the same way and invalidates
+// the ways holding the tag.
+// Inserts and removals share the read port with the lookup: the lookup of the cycle
+// after one misses, so each way is a single RAM with one read and one write port.
+module rv_fetch_btb
+#(
+    parameter int IADDR_SPACE_BITS      = 32,
+    parameter int TABLE_SIZE_BITS       = 4,
+    parameter int WAYS                  = 1,
+    parameter int TAG_BITS              = 8,
+    parameter logic EXTENSION_C         = 1
+)
+/* verilator lint_off UNUSEDSIGNAL */
+(
+    input   wire                        i_clk,
+    input   wire                        i_reset_n,
+    // lookup
+    input   wire[IADDR_SPACE_BITS-1:1]  i_pc_lookup,
+    input   wire[IADDR_SPACE_BITS-1:1]  i_pc_current,
+    output  wire                        o_hit,
+    output  wire                        o_jump,
+    output  wire[IADDR_SPACE_BITS-1:1]  o_pc_new,
+    output  wire                        o_lost,
+    // insert a taken jump/branch, remove the entry of a non-branch
+    input   wire                        i_insert,
+    input   wire                        i_remove,
+    input   wire                        i_jump,
+    input   wire[IADDR_SPACE_BITS-1:1]  i_pc_branch,
+    input   wire[IADDR_SPACE_BITS-1:1]  i_pc_target
+);
+/* verilator lint_on UNUSEDSIGNAL */
+
+    localparam int WAYS_BITS  = $clog2(WAYS);
+    localparam int SET_BITS   = TABLE_SIZE_BITS - WAYS_BITS;
+    localparam int SETS       = 2 ** SET_BITS;
+    // compressed branches are half-word aligned
+    localparam int IDX_LSB    = EXTENSION_C ? 1 : 2;
+    localparam int TAG_LSB    = IDX_LSB + SET_BITS;
+    localparam int TAG_W      = ((IADDR_SPACE_BITS - TAG_LSB) < TAG_BITS) ?
+                                (IADDR_SPACE_BITS - TAG_LSB) : TAG_BITS;
+    localparam int ENTRY_W    = 1 + TAG_W + (IADDR_SPACE_BITS - 1);
+
+    logic[SET_BITS-1:0] rd_set;
+    logic[SET_BITS-1:0] cur_set;
+    logic[TAG_W-1:0]    cur_tag;
+
+    // the read port serves an insert/removal first, the lookup otherwise
+    always_ff @(posedge i_clk)
+    begin
+        rd_set <= (i_insert | i_remove) ? i_pc_branch[IDX_LSB+:SET_BITS] :
+                                          i_pc_lookup[IDX_LSB+:SET_BITS];
+    end
+
+    assign  cur_set = i_pc_current[IDX_LSB+:SET_BITS];
+    assign  cur_tag = i_pc_current[TAG_LSB+:TAG_W];
+
+    // insert/removal, the first cycle
+    logic                       upd;
+    logic                       upd_remove;
+    logic                       upd_jump;
+    logic[SET_BITS-1:0]         upd_set;
+    logic[TAG_W-1:0]            upd_tag;
+    logic[IADDR_SPACE_BITS-1:1] upd_target;
+
+    always_ff @(posedge i_clk)
+    begin
+        if (!i_reset_n)
+        begin
+            upd <= '0;
+            upd_remove <= '0;
+        end
+        else
+        begin
+            upd <= i_insert;
+            upd_remove <= i_remove;
+        end
+        upd_jump <= i_jump;
+        upd_set <= i_pc_branch[IDX_LSB+:SET_BITS];
+        upd_tag <= i_pc_branch[TAG_LSB+:TAG_W];
+        upd_target <= i_pc_target;
+    end
+
+    logic[WAYS-1:0]             valid[SETS];
+    logic[WAYS-1:0]             way_hit;
+    logic[WAYS-1:0]             way_same;
+    logic[WAYS-1:0]             way_write;
+    logic[WAYS-1:0]             upd_valid;
+    logic[ENTRY_W-1:0]          rd_data[WAYS];
+
+    // valid bits are flip-flops, read by the same registered set as the RAMs
+    assign  upd_valid = valid[rd_set];
+
+    genvar i;
+    generate
+        for (i=0 ; i<WAYS ; i++)
+        begin : g_way
+            logic[ENTRY_W-1:0]  mem[SETS];
+            logic[ENTRY_W-1:0]  rd;
+
+            always_ff @(posedge i_clk)
+            begin
+                if (way_write[i])
+                    mem[upd_set] <= { upd_jump, upd_tag, upd_target };
+            end
+
+            assign  rd = mem[rd_set];
+            assign  rd_data[i] = rd;
+            assign  way_hit[i] = !(upd | upd_remove) & upd_valid[i] & (rd_set == cur_set) &
+                                 (rd[IADDR_SPACE_BITS-1+:TAG_W] == cur_tag);
+            assign  way_same[i] = upd_valid[i] & (rd[IADDR_SPACE_BITS-1+:TAG_W] == upd_tag);
+        end
+    endgenerate
+
+    // the same branch is rewritten in place, otherwise an invalid way or the victim
+    logic[WAYS-1:0]     way_free;
+    logic[WAYS-1:0]     way_victim;
+
+    always_comb
+    begin
+        way_free = '0;
+        for (int j=WAYS-1 ; j>=0 ; j--)
+        begin
+            if (!upd_valid[j])
+                way_free = WAYS'(1) << j;
+        end
+    end
+
+    generate
+        if (WAYS > 1)
+        begin : g_rr
+            logic[WAYS_BITS-1:0]    rr[SETS];
+
+            always_ff @(posedge i_clk)
+            begin
+                if (!i_reset_n)
+                begin
+                    for (int j=0 ; j<SETS ; j++)
+                        rr[j] <= '0;
+                end
+                else if (upd & !(|way_same) & !(|way_free))
+                    rr[upd_set] <= rr[upd_set] + 1'b1;
+            end
+
+            assign  way_victim = WAYS'(1) << rr[upd_set];
+        end
+        else
+        begin : g_dm
+            assign  way_victim = 1'b1;
+        end
+    endgenerate
+
+    assign  way_write = !upd ? '0 :
+                        (|way_same) ? way_same :
+                        (|way_free) ? way_free :
+                        way_victim;
+
+    always_ff @(posedge i_clk)
+    begin
+        if (!i_reset_n)
+        begin
+            for (int j=0 ; j<SETS ; j++)
+                valid[j] <= '0;
+        end
+        else if (upd)
+            valid[upd_set] <= upd_valid | way_write;
+        else if (upd_remove)
+            valid[upd_set] <= upd_valid & (~way_same);
+    end
+
+    // the lowest hit way, several ones may hold the same branch after close inserts
+    logic[ENTRY_W-1:0]  hit_data;
+
+    always_comb
+    begin
+        hit_data = '0;
+        for (int j=WAYS-1 ; j>=0 ; j--)
+        begin
+            if (way_hit[j])
+                hit_data = rd_data[j];
+        end
+    end
+
+    assign  o_hit = |way_hit;
+    assign  o_jump = hit_data[ENTRY_W-1];
+    assign  o_pc_new = hit_data[IADDR_SPACE_BITS-2:0];
+    // the read port serves an insert/removal, the lookup misses whatever the table holds
+    assign  o_lost = upd | upd_remove;
+
+endmodule
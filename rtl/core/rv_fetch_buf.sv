@@ -17,6 +17,7 @@ module rv_fetch_buf
     output  wire[WIDTH-1:0]             o_data,
     output  wire[IADDR_SPACE_BITS-1:1]  o_pc,
     output  wire[IADDR_SPACE_BITS-1:1]  o_pc_next,
+    output  wire[IADDR_SPACE_BITS-1:1]  o_pc_lookup,
     output  wire                        o_not_empty,
     output  wire                        o_not_full
 );
@@ -149,7 +150,10 @@ module rv_fetch_buf
 
     assign  o_data = { data_hi, data_lo };
     assign  o_pc = pc;
-    assign  o_pc_next = pc_next;
+    // address of the following instruction, the buffer may be reset by a predicted jump
+    assign  o_pc_next = pc_add;
+    // head address of the next cycle, for lookups with a registered address
+    assign  o_pc_lookup = pc_next;
     assign  o_not_empty = !is_head[0] & !first_half;
     assign  o_not_full = not_full;
 
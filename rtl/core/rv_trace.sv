@@ -26,6 +26,7 @@ module rv_trace
     input   wire                        i_exec_stall,
     input   wire                        i_write_flush,
     input   wire                        i_write_stall,
+    input   wire                        i_trap,
     output  wire[4:0]                   o_rd,
     input   wire[31:0]                  i_rd
 );
@@ -44,6 +45,24 @@ module rv_trace
     logic       r_reg_write_wr, r_mem_write_wr, r_mem_read_wr;
 
     int f;
+    // text table into trace.txt, replaced by the binary record with +trace_bin=<file>
+    bit r_text_en;
+
+`ifdef TO_SIM
+    // retire stream for the harness (co-simulation, profiling, binary trace), see vrf/sim_retire.h
+    import "DPI-C" function void trace_retire(input int pc, input int instr, input bit reg_write,
+        input int reg_data, input bit mem_read, input bit mem_write, input int mem_addr,
+        input int mem_wdata, input int mem_rdata, input int mem_sel, input int rd_old,
+        input int flags);
+    import "DPI-C" function void trace_event(input int id);
+    export "DPI-C" function trace_retire_enable;
+
+    bit r_retire_en;
+
+    function void trace_retire_enable(input bit en);
+        r_retire_en = en;
+    endfunction
+`endif
 
     function static real get_ts();
         real ts;
@@ -314,15 +333,54 @@ module rv_trace
     assign  w_reset_falling =   r_reset_prev  & (!i_reset_n);
     assign  w_reset_rising  = (!r_reset_prev) &   i_reset_n;
 
+    // ebreak trap redirects the fetch, the trap flag stays set while alu2 stalls
+    logic   r_trap_prev;
+    logic   w_trap;
+
+    assign  w_trap = i_trap & (!r_trap_prev);
+
+`ifdef TO_SIM
+    localparam int EVENT_RESET_FALLING  = 1;
+    localparam int EVENT_RESET_RISING   = 2;
+    localparam int EVENT_TRAP           = 3;
+
+    logic[31:0] pipe_flags;
+    assign  pipe_flags = { 26'b0, i_exec2_ready, i_write_flush, i_exec2_stall, i_exec2_flush,
+                           i_exec_stall, i_exec_flush };
+`endif
+
     always_ff @(posedge i_clk)
     begin
         r_reset_prev <= i_reset_n;
-        if (w_reset_falling)
+        r_trap_prev <= i_trap;
+        if (w_reset_falling & r_text_en)
             print_event("Reset de-asserted");
-        if (w_reset_rising)
+        if (w_reset_rising & r_text_en)
             print_event("Reset asserted");
         if (|r_instr_wr & !i_write_stall)
-            print_decode(r_addr_wr, r_instr_wr, r_pc_wr, r_mem_read_wr, r_mem_write_wr);
+        begin
+            if (r_text_en)
+                print_decode(r_addr_wr, r_instr_wr, r_pc_wr, r_mem_read_wr, r_mem_write_wr);
+`ifdef TO_SIM
+            if (r_retire_en)
+                trace_retire(int'(r_pc_wr), r_instr_wr, r_reg_write_wr, i_reg_data, r_mem_read_wr,
+                    r_mem_write_wr, r_addr_wr, r_wdata_wr, i_bus_data, int'(r_sel_wr), i_rd,
+                    pipe_flags);
+`endif
+        end
+`ifdef TO_SIM
+        if (r_retire_en & w_reset_falling)
+            trace_event(EVENT_RESET_FALLING);
+        if (r_retire_en & w_reset_rising)
+            trace_event(EVENT_RESET_RISING);
+`endif
+        // after the retirement of the cycle, that instruction is older than the trap
+        if (w_trap & r_text_en)
+            print_event("Trap taken");
+`ifdef TO_SIM
+        if (r_retire_en & w_trap)
+            trace_event(EVENT_TRAP);
+`endif
     end
 
     always_ff @(posedge i_clk)
@@ -390,8 +448,12 @@ module rv_trace
 
     initial
     begin
-        f = $fopen("./trace.txt", "w");
-        print_head();
+        r_text_en = !$test$plusargs("trace_bin=");
+        if (r_text_en)
+        begin
+            f = $fopen("./trace.txt", "w");
+            print_head();
+        end
         //
         r_instr_exec = '0;
         r_reg_write_exec = '0;
@@ -407,6 +469,9 @@ module rv_trace
         r_reg_write_wr = '0;
         r_mem_write_wr = '0;
         r_mem_read_wr = '0;
+`ifdef TO_SIM
+        r_retire_en = '0;
+`endif
     end
 
     logic[4:0]  rd;
@@ -414,6 +479,7 @@ module rv_trace
 
 `ifdef TO_SIM
     final
+    if (r_text_en)
     begin
         if (|r_instr_wr)
             print_decode(r_addr_wr, r_instr_wr, r_pc_wr, r_mem_read_wr, r_mem_write_wr);
@@ -13,7 +13,8 @@ module rv_csr
     parameter logic EXTENSION_C         = 1,
     parameter logic EXTENSION_M         = 1,
     parameter logic EXTENSION_Zicntr    = 1,
-    parameter logic EXTENSION_Zihpm     = 0
+    parameter logic EXTENSION_Zihpm     = 0,
+    parameter int HPM_COUNTERS          = 4
 )
 (
     input   wire                        i_clk,
@@ -30,6 +31,7 @@ module rv_csr
     input   wire                        i_ebreak,
     input   wire                        i_instr_issued,
     input   wire                        i_timer_tick,
+    input   wire[`HPM_EVENTS-1:0]       i_hpm_events,
     input   wire[IADDR_SPACE_BITS-1:1]  i_pc_next,
     output  wire[31:0]                  o_data,
     output  wire[IADDR_SPACE_BITS-1:1]  o_ret_addr,
@@ -121,6 +123,37 @@ module rv_csr
         end
     endgenerate
 
+    logic[31:0] rdata_hpm;
+    logic       hpm_sel;
+
+    generate
+        if (EXTENSION_Zihpm)
+        begin : g_hpm
+            rv_csr_hpm
+            #(
+                .COUNTERS                       (HPM_COUNTERS)
+            )
+            u_hpm
+            (
+                .i_clk                          (i_clk),
+                .i_reset_n                      (i_reset_n),
+                .i_idx                          (idx),
+                .i_data                         (write_value),
+                .i_write                        (write),
+                .i_set                          (set),
+                .i_clear                        (clear),
+                .i_events                       (i_hpm_events),
+                .o_sel                          (hpm_sel),
+                .o_data                         (rdata_hpm)
+            );
+        end
+        else
+        begin : g_hpm_dummy
+            assign rdata_hpm = '0;
+            assign hpm_sel = '0;
+        end
+    endgenerate
+
     logic[31:1] ret_addr, trap_pc;
     rv_csr_machine
     #(
@@ -133,7 +166,7 @@ module rv_csr
     (
         .i_clk                          (i_clk),
         .i_reset_n                      (i_reset_n),
-        .i_sel                          (machine_level_category),
+        .i_sel                          (machine_level_category & (idx_sub_category == 2'b00)),
         .i_data                         (write_value),
         .i_idx                          (idx[7:0]),
         .i_write                        (write),
@@ -151,7 +184,8 @@ module rv_csr
     assign  o_ret_addr = ret_addr[IADDR_SPACE_BITS-1:1];
     assign  o_trap_pc = trap_pc[IADDR_SPACE_BITS-1:1];
     logic[31:0] data;
-    assign  data = user_level_category ? rdata_user :
+    assign  data = hpm_sel ? rdata_hpm :
+                   user_level_category ? rdata_user :
                    supervisor_level_category ? rdata_supervisor :
                    hypervisor_level_category ? rdata_hypervisor :
                    rdata_machine;
@@ -68,6 +68,19 @@ module rv_csr_cntr
         end
     endgenerate
 
+`ifdef TO_SIM
+    // counters for the run summary of the harness, see vrf/sim_summary.h
+    export "DPI-C" function csr_cntr_read;
+
+    function longint csr_cntr_read(input int idx);
+        case (idx)
+        0:          return longint'(cntr_cycle);
+        1:          return longint'(cntr_time);
+        default:    return longint'(cntr_inst_ret);
+        endcase
+    endfunction
+`endif
+
     assign  o_data =
                     sel_cycle ? cntr_cycle[31:0] :
                     sel_time ? cntr_time[31:0] :
@@ -0,0 +1,115 @@
+`timescale 1ps/1ps
+
+`include "../rv_defines.vh"
+
+// Zihpm: mhpmcounter3..(3+COUNTERS-1) with mhpmevent selectors, the others read as zero.
+// mhpmeventN holds an event number (`HPM_EV_*), the counter increments on every
+// cycle the event is active, 0 - the counter is stopped.
+// A counter write is applied to the incremented value, so csrr (csrrs with rs1 = x0,
+// set with zero data) doesn't lose the event of that cycle.
+module rv_csr_hpm
+#(
+    parameter int COUNTERS              = 4
+)
+/* verilator lint_off UNUSEDSIGNAL */
+(
+    input   wire                        i_clk,
+    input   wire                        i_reset_n,
+    input   wire[11:0]                  i_idx,
+    input   wire[31:0]                  i_data,
+    input   wire                        i_write,
+    input   wire                        i_set,
+    input   wire                        i_clear,
+    input   wire[`HPM_EVENTS-1:0]       i_events,
+    output  wire                        o_sel,
+    output  wire[31:0]                  o_data
+);
+/* verilator lint_on UNUSEDSIGNAL */
+
+    localparam int EVENT_BITS = $clog2(`HPM_EVENTS);
+
+    logic   sel_counter;    // mhpmcounterN, 0xB03..0xB1F
+    logic   sel_counterh;   // mhpmcounterNh, 0xB83..0xB9F
+    logic   sel_ucounter;   // hpmcounterN (read only), 0xC03..0xC1F
+    logic   sel_ucounterh;  // hpmcounterNh (read only), 0xC83..0xC9F
+    logic   sel_event;      // mhpmeventN, 0x323..0x33F
+    logic   sel_write;
+    logic   in_range;
+
+    // 0..2 of each range are cycle/time/instret
+    assign  in_range      = (i_idx[4:0] >= 5'd3);
+    assign  sel_counter   = (i_idx[11:5] == 7'b1011_000) & in_range;
+    assign  sel_counterh  = (i_idx[11:5] == 7'b1011_100) & in_range;
+    assign  sel_ucounter  = (i_idx[11:5] == 7'b1100_000) & in_range;
+    assign  sel_ucounterh = (i_idx[11:5] == 7'b1100_100) & in_range;
+    assign  sel_event     = (i_idx[11:5] == 7'b0011_001) & in_range;
+    assign  sel_write     = i_write | i_set | i_clear;
+
+    // event 0 never counts
+    logic[`HPM_EVENTS-1:0]  events;
+    assign  events = { i_events[`HPM_EVENTS-1:1], 1'b0 };
+
+    logic[31:0] rdata[COUNTERS];
+
+    genvar i;
+    generate
+        for (i=0 ; i<COUNTERS ; i++)
+        begin : g_cntr
+            logic                   sel;
+            logic[63:0]             cntr;
+            logic[63:0]             cntr_inc;
+            logic[31:0]             cntr_part;
+            logic[31:0]             cntr_next;
+            logic[EVENT_BITS-1:0]   event_sel;
+            logic[EVENT_BITS-1:0]   event_next;
+
+            assign  sel = (i_idx[4:0] == 5'(i + 3));
+            assign  cntr_inc = cntr + 64'(events[event_sel]);
+            assign  cntr_part = i_idx[7] ? cntr_inc[63:32] : cntr_inc[31:0];
+            assign  cntr_next = i_clear ? (cntr_part & (~i_data)) :
+                                i_set ? (cntr_part | i_data) :
+                                i_data;
+            assign  event_next = i_clear ? (event_sel & (~i_data[EVENT_BITS-1:0])) :
+                                 i_set ? (event_sel | i_data[EVENT_BITS-1:0]) :
+                                 i_data[EVENT_BITS-1:0];
+
+            always_ff @(posedge i_clk)
+            begin
+                if (!i_reset_n)
+                    event_sel <= '0;
+                else if (sel & sel_event & sel_write)
+                    event_sel <= event_next;
+            end
+
+            always_ff @(posedge i_clk)
+            begin
+                if (!i_reset_n)
+                    cntr <= '0;
+                else if (sel & sel_counter & sel_write)
+                    cntr <= { cntr_inc[63:32], cntr_next };
+                else if (sel & sel_counterh & sel_write)
+                    cntr <= { cntr_next, cntr_inc[31:0] };
+                else
+                    cntr <= cntr_inc;
+            end
+
+            assign  rdata[i] = !sel ? '0 :
+                               (sel_counter | sel_ucounter) ? cntr[31:0] :
+                               (sel_counterh | sel_ucounterh) ? cntr[63:32] :
+                               sel_event ? { {(32-EVENT_BITS){1'b0}}, event_sel } :
+                               '0;
+        end
+    endgenerate
+
+    logic[31:0] data;
+    always_comb
+    begin
+        data = '0;
+        for (int j=0 ; j<COUNTERS ; j++)
+            data = data | rdata[j];
+    end
+
+    assign  o_data = data;
+    assign  o_sel = sel_counter | sel_counterh | sel_ucounter | sel_ucounterh | sel_event;
+
+endmodule
@@ -286,6 +286,38 @@ module rv_csr_machine
                         '0;
     assign  o_ret_addr = mepc_data;
 
+`ifdef TO_SIM
+    // backdoor access for the simulation harness (fast-forward state injection),
+    // registers are reset together with the core, so they're written after it
+    export "DPI-C" function csr_machine_in_reset;
+    export "DPI-C" function csr_machine_write;
+
+    function int csr_machine_in_reset();
+        return int'(!i_reset_n);
+    endfunction
+
+    function void csr_machine_write(input int idx, input int data);
+        case (idx[7:0])
+        8'h00:  MIE = data[3];
+        8'h04:
+        begin
+            MEIE = data[11];
+            MTIE = data[7];
+            MSIE = data[3];
+        end
+        8'h05:  u_mtvec.data = data;
+        8'h40:  u_mscratch.data = data;
+        8'h41:  mepc_data = data[31:1];
+        8'h42:
+        begin
+            mcause_is_int = data[31];
+            mcause_code = data[3:0];
+        end
+        default: ;
+        endcase
+    endfunction
+`endif
+
     assign  o_data = sel_mstatus ? mstatus_data :
                      sel_misa ? misa_data :
                      sel_mie ? mie_data :
@@ -2,6 +2,7 @@ SRCS += $(RTL_DIR)/rv_top_wb.sv
 SRCS += $(RTL_DIR)/tcm.sv
 SRCS += $(RTL_DIR)/nic.sv
 SRCS += $(RTL_DIR)/debounce.sv
+SRCS += $(RTL_DIR)/min_idx.sv
 SRCS += $(RTL_DIR)/../vrf/tb_top.sv
 SRCS += $(RTL_DIR)/core/rv_core.sv
 SRCS += $(RTL_DIR)/core/rv_ctrl.sv
@@ -10,6 +11,8 @@ SRCS += $(RTL_DIR)/core/rv_trace.sv
 SRCS += $(RTL_DIR)/core/rv_fetch.sv
 SRCS += $(RTL_DIR)/core/rv_fetch_addr.sv
 SRCS += $(RTL_DIR)/core/rv_fetch_buf.sv
+SRCS += $(RTL_DIR)/core/rv_fetch_branch_pred.sv
+SRCS += $(RTL_DIR)/core/rv_fetch_btb.sv
 SRCS += $(RTL_DIR)/core/rv_decode.sv
 SRCS += $(RTL_DIR)/core/rv_decode_comp.sv
 SRCS += $(RTL_DIR)/core/rv_hazard.sv
@@ -25,6 +28,7 @@ SRCS += $(RTL_DIR)/core/math/pc_sel.sv
 SRCS += $(RTL_DIR)/core/math/wr_mux.sv
 SRCS += $(RTL_DIR)/csr/rv_csr.sv
 SRCS += $(RTL_DIR)/csr/rv_csr_cntr.sv
+SRCS += $(RTL_DIR)/csr/rv_csr_hpm.sv
 SRCS += $(RTL_DIR)/csr/rv_csr_machine.sv
 SRCS += $(RTL_DIR)/csr/rv_csr_reg.sv
 #SRCS += $(RTL_DIR)/lib_fpga/reg_e.sv
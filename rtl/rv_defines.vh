@@ -14,3 +14,14 @@
 `endif
 
 //`define USE_SCHEMATIC
+
+// Zihpm events, mhpmeventN values (fw/common/hpm.h)
+`define HPM_EVENTS                      16
+`define HPM_EV_FETCH_EMPTY              1   // decode waits for the fetch buffer
+`define HPM_EV_DATA_STALL               2   // decode stalled on memory data (rv_ctrl need_mem_data)
+`define HPM_EV_MULDIV_BUSY              3   // mul/div in progress (rv_alu2 state machine)
+`define HPM_EV_FLUSH                    4   // pipeline flush, pc change
+`define HPM_EV_BTB_HIT                  5   // branch taken as predicted by the BTB
+`define HPM_EV_BTB_MISS                 6   // branch mispredicted or missed the BTB
+`define HPM_EV_BUS_CONFLICT             7   // instruction fetch held off by a data access
+`define HPM_EV_BTB_LOST                 8   // BTB lookup lost to an insert/removal (rv_fetch_btb)
@@ -13,6 +13,10 @@ module rv_top_wb
 `endif
     parameter logic BRANCH_PREDICTION   = 0,
     parameter int BRANCH_TABLE_SIZE_BITS= 3,
+    parameter int BRANCH_TABLE_WAYS     = 0,
+    parameter int BRANCH_TAG_BITS       = 8,
+    parameter int BRANCH_BHT_SIZE_BITS  = 6,
+    parameter int BRANCH_GHR_BITS       = 0,
     parameter int INSTR_BUF_ADDR_SIZE   = 2,
     parameter logic ALU2_ISOLATED       = 1,
     parameter logic TIMER_ENABLE        = 0,
@@ -21,7 +25,8 @@ module rv_top_wb
     parameter logic EXTENSION_M         = 1,
     parameter logic EXTENSION_Zicsr     = 1,
     parameter logic EXTENSION_Zicntr    = 1,
-    parameter logic EXTENSION_Zihpm     = 0
+    parameter logic EXTENSION_Zihpm     = 0,
+    parameter int HPM_COUNTERS          = 4
 )
 (
     input   wire                        i_clk,
@@ -49,8 +54,18 @@ module rv_top_wb
             if (EXTENSION_Zihpm)
                 $error("Invalid configuration! Zihpm w/o Zicsr");
         end
+        // not verified yet, the architecture tests are run on it with BP_C_UNVERIFIED
+`ifndef BP_C_UNVERIFIED
         if (BRANCH_PREDICTION & EXTENSION_C)
             $error("Invalid configuration! C and branch prediction");
+`endif
+        // indexed BTB: power of two ways, at least two sets
+        if (BRANCH_PREDICTION && (BRANCH_TABLE_WAYS != 0))
+        begin : g_btb_check
+            if (((BRANCH_TABLE_WAYS & (BRANCH_TABLE_WAYS - 1)) != 0) ||
+                ((2 * BRANCH_TABLE_WAYS) > (2 ** BRANCH_TABLE_SIZE_BITS)))
+                $error("Invalid configuration! BTB ways");
+        end
     endgenerate
 `endif
 
@@ -83,6 +98,11 @@ module rv_top_wb
     logic       csr_oread;
     logic[31:0] reg_rdata1;
     logic       instr_issued;
+`ifdef TO_SIM
+    logic[31:0] core_debug;
+`endif
+    logic[`HPM_EVENTS-1:0]  core_events;
+    logic[`HPM_EVENTS-1:0]  hpm_events;
 
     rv_core
     #(
@@ -90,6 +110,10 @@ module rv_top_wb
         .IADDR_SPACE_BITS               (IADDR_SPACE_BITS),
         .BRANCH_PREDICTION              (BRANCH_PREDICTION),
         .BRANCH_TABLE_SIZE_BITS         (BRANCH_TABLE_SIZE_BITS),
+        .BRANCH_TABLE_WAYS              (BRANCH_TABLE_WAYS),
+        .BRANCH_TAG_BITS                (BRANCH_TAG_BITS),
+        .BRANCH_BHT_SIZE_BITS           (BRANCH_BHT_SIZE_BITS),
+        .BRANCH_GHR_BITS                (BRANCH_GHR_BITS),
         .INSTR_BUF_ADDR_SIZE            (INSTR_BUF_ADDR_SIZE),
         .ALU2_ISOLATED                  (ALU2_ISOLATED),
         .EXTENSION_C                    (EXTENSION_C),
@@ -102,7 +126,7 @@ module rv_top_wb
         .i_clk                          (i_clk),
         .i_reset_n                      (i_reset_n),
 `ifdef TO_SIM
-        .o_debug                        (o_debug),
+        .o_debug                        (core_debug),
 `endif
         .o_csr_idx                      (csr_idx),
         .o_csr_imm                      (csr_imm),
@@ -131,9 +155,22 @@ module rv_top_wb
         .o_data_sel                     (data_sel),
         .i_data_ack                     (data_ack),
         .i_data_rdata                   (data_rdata),
-        .o_instr_issued                 (instr_issued)
+        .o_instr_issued                 (instr_issued),
+        .o_hpm_events                   (core_events)
     );
 
+    // the data access wins the shared bus, the instruction request waits
+    always_comb
+    begin
+        hpm_events = core_events;
+        hpm_events[`HPM_EV_BUS_CONFLICT] = data_req & instr_req;
+    end
+
+`ifdef TO_SIM
+    // bit 11 - bus conflict, the others are driven by rv_core
+    assign  o_debug = core_debug | { 20'b0, hpm_events[`HPM_EV_BUS_CONFLICT], 11'b0 };
+`endif
+
     generate
         if (EXTENSION_Zicsr)
         begin : g_csr
@@ -144,7 +181,8 @@ module rv_top_wb
                 .EXTENSION_C                    (EXTENSION_C),
                 .EXTENSION_M                    (EXTENSION_M),
                 .EXTENSION_Zicntr               (EXTENSION_Zicntr),
-                .EXTENSION_Zihpm                (EXTENSION_Zihpm)
+                .EXTENSION_Zihpm                (EXTENSION_Zihpm),
+                .HPM_COUNTERS                   (HPM_COUNTERS)
             )
             u_st3_csr
             (
@@ -163,6 +201,7 @@ module rv_top_wb
                 .i_pc_next                      (csr_pc_next),
                 .i_instr_issued                 (instr_issued),
                 .i_timer_tick                   (1'b0),
+                .i_hpm_events                   (hpm_events),
                 .o_read                         (csr_oread),
                 .o_ret_addr                     (ret_addr),
                 .o_csr_to_trap                  (csr_to_trap),
@@ -182,7 +221,7 @@ module rv_top_wb
             assign csr_rdata = '0;
             assign dummy = (|reg_rdata1) | (|csr_idx) | (|csr_imm) | csr_imm_sel |
                             csr_write | csr_set | csr_clear | csr_read | csr_ebreak |
-                            (|csr_pc_next) | instr_issued;
+                            (|csr_pc_next) | instr_issued | (|hpm_events);
         end
 
         if (ALU2_ISOLATED)
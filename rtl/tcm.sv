@@ -70,13 +70,27 @@ module tcm
     assign o_data = r_mem[addr];
     assign  o_ack = r_ack;
 
+`ifdef TO_SIM
+    // backdoor access for the simulation harness (ELF loader, signatures)
+    export "DPI-C" function tcm_write;
+    export "DPI-C" function tcm_read;
+
+    function void tcm_write(input int idx, input int data);
+        r_mem[idx[MEM_ADDR_WIDTH-1:0]] = data;
+    endfunction
+
+    function int tcm_read(input int idx);
+        return r_mem[idx[MEM_ADDR_WIDTH-1:0]];
+    endfunction
+`endif
+
     initial
     begin
     `ifdef TO_SIM
         string fw_file;
         if ($value$plusargs("TEST_FW=%s", fw_file))
             $readmemh(fw_file, r_mem);
-        else
+        else if (!$test$plusargs("elf=")) // +elf= is loaded by the harness
             $readmemh("fw.vh", r_mem);
     `else
       `ifndef QUARTUS
@@ -0,0 +1,196 @@
+#!/usr/bin/env python3
+# Runs riscv-arch-test suites on a single Verilated model per ISA configuration.
+# Test ELFs are loaded with +elf=, so every test reuses the same binary and tests
+# are spread over a pool of worker processes. A test passes when it finishes and its
+# memory signature (+signature=) matches references/<test>.reference_output of the
+# suite. Results are merged into results.json.
+#
+# Usage: arch_runner.py [-j JOBS] [--config NAME ...] [--device I C M] [--cycles N]
+#                       [--tcm model|dpi]
+
+import argparse
+import glob
+import multiprocessing
+import os
+import re
+import subprocess
+import sys
+
+import results_db
+
+SIM_DIR = os.path.dirname(os.path.abspath(__file__))
+ROOT_DIR = os.path.join(SIM_DIR, "..", "fw", "riscv-arch-test")
+SUITE_DIR = os.path.join(ROOT_DIR, "riscv-test-suite")
+TARGET_DIR = os.path.join(ROOT_DIR, "riscv-target", "mycore")
+OUT_DIR = os.path.join(SUITE_DIR, "out")
+RESULTS = os.path.join(SIM_DIR, "..", "results.json")
+
+GCC = "riscv32-unknown-elf-gcc"
+
+# suites, same as sim/Makefile.tests_*.mak
+DEVICES = {
+    "I": "-march=rv32i",
+    "C": "-march=rv32ic_zicsr_zifencei",
+    "M": "-march=rv32i_m",
+}
+
+# model configurations, "params" are tb_top parameters (make gparams=...), "make" are
+# extra arguments of the model build
+CONFIGS = {
+    "rv32imc": {"devices": ["I", "C", "M"], "params": []},
+    "rv32im": {"devices": ["I", "M"], "params": ["EXTENSION_C=0"]},
+    # Zihpm counters and event selectors in the CSR address space
+    "rv32imc_hpm": {"devices": ["I", "C", "M"], "params": ["EXTENSION_Zihpm=1"]},
+    # branch prediction, the cores of the rv32i_pb2_btb/rv32ic_pb2_btb performance configurations
+    "rv32i_btb": {"devices": ["I"],
+                  "params": ["EXTENSION_C=0", "EXTENSION_M=0", "BRANCH_PREDICTION=1",
+                             "BRANCH_TABLE_SIZE_BITS=3"]},
+    # indexed BTB, 64 entries direct-mapped and 2-way
+    "rv32i_btb_1way": {"devices": ["I"],
+                       "params": ["EXTENSION_C=0", "EXTENSION_M=0", "BRANCH_PREDICTION=1",
+                                  "BRANCH_TABLE_SIZE_BITS=6", "BRANCH_TABLE_WAYS=1"]},
+    "rv32i_btb_2way": {"devices": ["I"],
+                       "params": ["EXTENSION_C=0", "EXTENSION_M=0", "BRANCH_PREDICTION=1",
+                                  "BRANCH_TABLE_SIZE_BITS=6", "BRANCH_TABLE_WAYS=2"]},
+    # branch prediction with the C extension, fully associative and set-associative BTB,
+    # rejected by rv_top_wb unless built with bp_c=1 until these pass
+    "rv32ic_btb": {"devices": ["I", "C"], "make": ["bp_c=1"],
+                   "params": ["EXTENSION_M=0", "BRANCH_PREDICTION=1", "BRANCH_TABLE_SIZE_BITS=3"]},
+    "rv32imc_btb": {"devices": ["I", "C", "M"], "make": ["bp_c=1"],
+                    "params": ["EXTENSION_C=1", "BRANCH_PREDICTION=1", "BRANCH_TABLE_SIZE_BITS=3"]},
+    "rv32imc_btb_2way": {"devices": ["I", "C", "M"], "make": ["bp_c=1"],
+                         "params": ["EXTENSION_C=1", "BRANCH_PREDICTION=1", "BRANCH_TABLE_SIZE_BITS=6",
+                                    "BRANCH_TABLE_WAYS=2"]},
+}
+
+RE_CYCLES = re.compile(r"^Simulation time: .*, (\d+)/\d+ cycles", re.M)
+
+
+def build_model(cfg, tcm):
+    run_dir = os.path.join(SIM_DIR, "run_" + cfg)
+    os.makedirs(run_dir, exist_ok=True)
+    params = " ".join(CONFIGS[cfg]["params"])
+    with open(os.path.join(run_dir, "build.log"), "w") as log:
+        ret = subprocess.call(["make", "-C", run_dir, "-f", "../Makefile.main", "tb_top",
+                               "cycles=1", "gparams=" + params, "tcm=" + tcm] +
+                              CONFIGS[cfg].get("make", []),
+                              stdout=log, stderr=log)
+    if ret != 0:
+        print("%s: model build failed, see %s/build.log" % (cfg, run_dir))
+        return None
+    return os.path.join(run_dir, "obj_dir", "Vtb_top")
+
+
+def compile_test(args):
+    dev, src = args
+    name = os.path.splitext(os.path.basename(src))[0]
+    # own directory per test, the model writes trace.txt into its working directory
+    test_dir = os.path.join(OUT_DIR, dev, name)
+    os.makedirs(test_dir, exist_ok=True)
+    elf = os.path.join(test_dir, name + ".elf")
+    if os.path.exists(elf) and os.path.getmtime(elf) > os.path.getmtime(src):
+        return (name, elf)
+    cmd = [GCC, DEVICES[dev], "-mabi=ilp32", "-static", "-mcmodel=medany",
+           "-fvisibility=hidden", "-nostdlib", "-nostartfiles", "-DXLEN=32",
+           "-DTEST_CASE_1=True", "-I" + os.path.join(SUITE_DIR, "env"), "-I" + TARGET_DIR,
+           "-T" + os.path.join(TARGET_DIR, "link.ld"), src, "-o", elf]
+    if subprocess.call(cmd) != 0:
+        return (name, None)
+    return (name, elf)
+
+
+def read_words(file_name):
+    with open(file_name) as f:
+        return [line.strip().lower() for line in f if line.strip()]
+
+
+# None when the signature matches the reference, otherwise the reason
+def check_signature(dev, name, signature):
+    ref = os.path.join(SUITE_DIR, "rv32i_m", dev, "references", name + ".reference_output")
+    if not os.path.exists(ref):
+        return "no reference %s" % ref
+    if not os.path.exists(signature):
+        return "no signature"
+    sig_words = read_words(signature)
+    ref_words = read_words(ref)
+    for i, (s, r) in enumerate(zip(sig_words, ref_words)):
+        if s != r:
+            return "signature word %d: %s, expected %s" % (i, s, r)
+    if len(sig_words) != len(ref_words):
+        return "signature has %d words, expected %d" % (len(sig_words), len(ref_words))
+    return None
+
+
+def run_test(args):
+    model, dev, name, elf, cycles = args
+    if elf is None:
+        return {"name": "test_" + name, "result": "Fail", "cycles": 0}
+    signature = os.path.splitext(elf)[0] + ".signature"
+    if os.path.exists(signature):
+        os.remove(signature)
+    res = subprocess.run([model, "+elf=" + elf, "+cycles=%d" % cycles, "+signature=" + signature],
+                         cwd=os.path.dirname(elf), stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                         universal_newlines=True)
+    m = RE_CYCLES.search(res.stdout)
+    rec = {"name": "test_" + name, "cycles": int(m.group(1)) if m else 0}
+    if ("Finished. Ok." in res.stdout) and (res.returncode == 0):
+        error = check_signature(dev, name, signature)
+    else:
+        error = "not finished"
+    if error is None:
+        rec["result"] = "Pass"
+    else:
+        rec["result"] = "Fail"
+        rec["error"] = error
+        with open(os.path.splitext(elf)[0] + ".log", "w") as f:
+            f.write(res.stdout)
+            f.write("arch_runner: %s\n" % error)
+    return rec
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("-j", "--jobs", type=int, default=multiprocessing.cpu_count())
+    parser.add_argument("--config", nargs="+", default=["rv32imc"], choices=CONFIGS.keys())
+    parser.add_argument("--device", nargs="+", default=None, choices=DEVICES.keys())
+    parser.add_argument("--cycles", type=int, default=1000000)
+    # "dpi" keeps the TCM in a sparse harness memory, so parallel models stay small
+    parser.add_argument("--tcm", default="dpi", choices=["model", "dpi"])
+    args = parser.parse_args()
+
+    records = []
+    failed = 0
+    with multiprocessing.Pool(args.jobs) as pool:
+        for cfg in args.config:
+            model = build_model(cfg, args.tcm)
+            if model is None:
+                return 1
+            devices = [d for d in CONFIGS[cfg]["devices"] if args.device is None or d in args.device]
+            jobs = []
+            for dev in devices:
+                srcs = sorted(glob.glob(os.path.join(SUITE_DIR, "rv32i_m", dev, "src", "*.S")))
+                jobs += [(dev, src) for src in srcs]
+            tests = pool.map(compile_test, jobs)
+            runs = [(model, dev, name, elf, args.cycles)
+                    for (dev, _), (name, elf) in zip(jobs, tests)]
+            for rec in pool.imap_unordered(run_test, runs):
+                # the reason is in the log of the test, results.json keeps pass/fail only
+                error = rec.pop("error", None)
+                print("%s: %-32s %s %d cycles%s" % (cfg, rec["name"], rec["result"], rec["cycles"],
+                                                    (", " + error) if error else ""))
+                if rec["result"] != "Pass":
+                    failed += 1
+                # results of several configurations are kept apart
+                if len(args.config) > 1:
+                    rec["name"] = "%s/%s" % (cfg, rec["name"])
+                records.append(rec)
+
+    data = results_db.load(RESULTS)
+    results_db.merge(data, "tests", records)
+    results_db.save(RESULTS, data)
+    print("Passed %d/%d" % (len(records) - failed, len(records)))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,25 @@
+#!/bin/sh
+# Simulated cycles/s per branch target buffer: "none" - no branch prediction,
+# 0 - fully associative (8 entries), 1/2/4 - indexed, 64 entries of that many ways.
+# Usage: bench_btb.sh <cycles> <ways...>
+# Firmware is taken from run/fw.vh, so build it first (make sim fw=...). Models keep
+# the default C extension, built with bp_c=1 (rv_top_wb rejects C with prediction).
+
+CYCLES=$1
+shift
+
+for w in "$@"
+do
+    case $w in
+        none) PARAMS="BRANCH_PREDICTION=0" ;;
+        0) PARAMS="BRANCH_PREDICTION=1 BRANCH_TABLE_SIZE_BITS=3 BRANCH_TABLE_WAYS=0" ;;
+        *) PARAMS="BRANCH_PREDICTION=1 BRANCH_TABLE_SIZE_BITS=6 BRANCH_TABLE_WAYS=$w" ;;
+    esac
+    RUN_DIR=run_btb_$w
+    mkdir -p $RUN_DIR
+    make -C $RUN_DIR -f ../Makefile.main tb_top cycles=1 bp_c=1 gparams="$PARAMS" > \
+        $RUN_DIR/build.log 2>&1 || { echo "ways=$w: build failed, see $RUN_DIR/build.log"; continue; }
+    RES=$(cd $RUN_DIR && ./obj_dir/Vtb_top +TEST_FW=../run/fw.vh +cycles=$CYCLES | \
+        grep "^Simulation time")
+    echo "ways=$w: ${RES#Simulation time: }"
+done
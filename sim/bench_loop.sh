@@ -0,0 +1,23 @@
+#!/bin/sh
+# Simulated cycles/s of the cycle-batched run loop (vrf/sim_run.h) against the
+# per-time-unit loop of TB::run_steps() (+step_loop), the same model for both.
+# Usage: bench_loop.sh <cycles> <batch...>
+# Firmware is taken from run/fw.vh, so build it first (make sim fw=...).
+
+CYCLES=$1
+shift
+
+RUN_DIR=run_loop
+mkdir -p $RUN_DIR
+make -C $RUN_DIR -f ../Makefile.main tb_top cycles=1 > $RUN_DIR/build.log 2>&1 || \
+    { echo "build failed, see $RUN_DIR/build.log"; exit 1; }
+
+RES=$(cd $RUN_DIR && ./obj_dir/Vtb_top +TEST_FW=../run/fw.vh +cycles=$CYCLES +step_loop | \
+    grep "^Simulation time")
+echo "step loop: ${RES#Simulation time: }"
+for b in "$@"
+do
+    RES=$(cd $RUN_DIR && ./obj_dir/Vtb_top +TEST_FW=../run/fw.vh +cycles=$CYCLES +batch=$b | \
+        grep "^Simulation time")
+    echo "batch=$b: ${RES#Simulation time: }"
+done
@@ -0,0 +1,18 @@
+#!/bin/sh
+# Build tb_top with each thread count and report simulated cycles/s.
+# Usage: bench_threads.sh <cycles> <threads...>
+# Firmware is taken from run/fw.vh, so build it first (make sim fw=...).
+
+CYCLES=$1
+shift
+
+for t in "$@"
+do
+    RUN_DIR=run_t$t
+    mkdir -p $RUN_DIR
+    make -C $RUN_DIR -f ../Makefile.main tb_top threads=$t cycles=1 > $RUN_DIR/build.log 2>&1 || \
+        { echo "threads=$t: build failed, see $RUN_DIR/build.log"; continue; }
+    RES=$(cd $RUN_DIR && ./obj_dir/Vtb_top +TEST_FW=../run/fw.vh +cycles=$CYCLES +threads=$t | \
+        grep "^Simulation time")
+    echo "threads=$t: ${RES#Simulation time: }"
+done
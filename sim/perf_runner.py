@@ -0,0 +1,300 @@
+#!/usr/bin/env python3
+# Performance regression suite: builds a Verilated model per core configuration
+# (the rows of the readme performance table), runs Dhrystone and CoreMark on each
+# of them in parallel (ELFs loaded with +elf=) and merges Dhrystones/s, DMIPS/MHz
+# and CoreMark/MHz into the "performance" section of results.json.
+# A metric which drops by more than the threshold against the recorded value
+# fails the run, the recorded value is kept then (--accept overrides it).
+# Configurations with a "baseline" (the same core without branch prediction)
+# also get the gain of every metric over it, <metric>_gain (percent).
+# Configurations with "hpm" run the benchmarks built with a set of Zihpm counters
+# (fw/common/hpm.h), the printed counters are checked and recorded as hpm_<event>.
+#
+# Usage: perf_runner.py [-j JOBS] [--config NAME ...] [--bench NAME ...]
+#                       [--threshold PERCENT] [--accept] [--tcm model|dpi]
+
+import argparse
+import multiprocessing
+import os
+import re
+import subprocess
+import sys
+
+import results_db
+
+SIM_DIR = os.path.dirname(os.path.abspath(__file__))
+FW_DIR = os.path.join(SIM_DIR, "..", "fw")
+RESULTS = os.path.join(SIM_DIR, "..", "results.json")
+
+# model configurations, "params" are tb_top parameters (make gparams=...),
+# "arch" is the firmware ISA (DEV_ARCH of fw/Makefile.include), "baseline" is the
+# configuration the gain of the branch predictor is measured against, "hpm" builds
+# the firmware with a set of Zihpm counters (the core needs EXTENSION_Zihpm=1), "make" are
+# extra arguments of the model build
+CONFIGS = {
+    "rv32i_pb2": {"arch": "rv32i_zicsr",
+                  "params": ["EXTENSION_C=0", "EXTENSION_M=0", "INSTR_BUF_ADDR_SIZE=2",
+                             "ALU2_ISOLATED=0"]},
+    "rv32ic_pb2": {"arch": "rv32i_c_zicsr",
+                   "params": ["EXTENSION_M=0", "INSTR_BUF_ADDR_SIZE=2", "ALU2_ISOLATED=0"]},
+    "rv32ic_pb2_alu2": {"arch": "rv32i_c_zicsr",
+                        "params": ["EXTENSION_M=0", "INSTR_BUF_ADDR_SIZE=2", "ALU2_ISOLATED=1"]},
+    "rv32imc_pb2_alu2": {"arch": "rv32i_m_c_zicsr",
+                         "params": ["EXTENSION_M=1", "INSTR_BUF_ADDR_SIZE=2", "ALU2_ISOLATED=1"]},
+    "rv32imc_pb2_alu2_hpm": {"arch": "rv32i_m_c_zicsr", "hpm": "core",
+                             "params": ["EXTENSION_M=1", "INSTR_BUF_ADDR_SIZE=2", "ALU2_ISOLATED=1",
+                                        "EXTENSION_Zihpm=1"]},
+    # C with branch prediction, rejected by rv_top_wb unless built with bp_c=1
+    "rv32ic_pb2_btb": {"arch": "rv32i_c_zicsr", "baseline": "rv32ic_pb2", "make": ["bp_c=1"],
+                       "params": ["EXTENSION_M=0", "INSTR_BUF_ADDR_SIZE=2", "ALU2_ISOLATED=0",
+                                  "BRANCH_PREDICTION=1", "BRANCH_TABLE_SIZE_BITS=3"]},
+    "rv32imc_pb2_alu2_btb": {"arch": "rv32i_m_c_zicsr", "baseline": "rv32imc_pb2_alu2",
+                             "make": ["bp_c=1"],
+                             "params": ["EXTENSION_M=1", "INSTR_BUF_ADDR_SIZE=2", "ALU2_ISOLATED=1",
+                                        "BRANCH_PREDICTION=1", "BRANCH_TABLE_SIZE_BITS=3"]},
+    "rv32i_pb2_btb": {"arch": "rv32i_zicsr", "baseline": "rv32i_pb2",
+                      "params": ["EXTENSION_C=0", "EXTENSION_M=0", "INSTR_BUF_ADDR_SIZE=2",
+                                 "ALU2_ISOLATED=0", "BRANCH_PREDICTION=1",
+                                 "BRANCH_TABLE_SIZE_BITS=3"]},
+    "rv32i_pb2_btb_gshare": {"arch": "rv32i_zicsr", "baseline": "rv32i_pb2",
+                             "params": ["EXTENSION_C=0", "EXTENSION_M=0", "INSTR_BUF_ADDR_SIZE=2",
+                                        "ALU2_ISOLATED=0", "BRANCH_PREDICTION=1",
+                                        "BRANCH_TABLE_SIZE_BITS=3", "BRANCH_GHR_BITS=4"]},
+    "rv32ic_pb2_btb64_2way": {"arch": "rv32i_c_zicsr", "baseline": "rv32ic_pb2",
+                              "make": ["bp_c=1"],
+                              "params": ["EXTENSION_M=0", "INSTR_BUF_ADDR_SIZE=2", "ALU2_ISOLATED=0",
+                                         "BRANCH_PREDICTION=1", "BRANCH_TABLE_SIZE_BITS=6",
+                                         "BRANCH_TABLE_WAYS=2"]},
+    # indexed BTB, 64 entries direct-mapped and 2-way, with the lookups lost to updates
+    "rv32i_pb2_btb64_1way": {"arch": "rv32i_zicsr", "baseline": "rv32i_pb2", "hpm": "btb",
+                             "params": ["EXTENSION_C=0", "EXTENSION_M=0", "INSTR_BUF_ADDR_SIZE=2",
+                                        "ALU2_ISOLATED=0", "EXTENSION_Zihpm=1",
+                                        "BRANCH_PREDICTION=1", "BRANCH_TABLE_SIZE_BITS=6",
+                                        "BRANCH_TABLE_WAYS=1"]},
+    "rv32i_pb2_btb64_2way": {"arch": "rv32i_zicsr", "baseline": "rv32i_pb2", "hpm": "btb",
+                             "params": ["EXTENSION_C=0", "EXTENSION_M=0", "INSTR_BUF_ADDR_SIZE=2",
+                                        "ALU2_ISOLATED=0", "EXTENSION_Zihpm=1",
+                                        "BRANCH_PREDICTION=1", "BRANCH_TABLE_SIZE_BITS=6",
+                                        "BRANCH_TABLE_WAYS=2"]},
+}
+
+# "hz" is the -DHZ of the firmware, the timers count cycles of the core,
+# so per MHz figures are related to it, "hpm" are the sets of Zihpm counters: the make
+# arguments enabling them and the events they count, the order of the printout
+BENCHES = {
+    "dhrystone": {"dir": "dhrystone", "hz": 117000000, "make": ["sim=1"]},
+    "coremark": {"dir": "coremark", "hz": 75000000,
+                 "make": ["PORT_DIR=../coremark_port", "sim=1"], "port": "coremark_port",
+                 "hpm": {"core": {"make": ["hpm=1"],
+                                  "events": ["fetch empty", "data stall", "mul/div busy", "flush"]},
+                         "btb": {"make": ["hpm=btb"],
+                                 "events": ["btb hit", "btb miss", "btb lost", "flush"]}}},
+}
+
+# VAX 11/780 Dhrystones/s, 1 DMIPS
+DHRYSTONE_VAX = 1757
+
+RE_DHRYSTONE = re.compile(r"^Dhrystones per Second:\s*(\d+)", re.M)
+RE_COREMARK = re.compile(r"^Iterations/Sec\s*:\s*([\d.]+)", re.M)
+RE_CYCLES = re.compile(r"^Simulation time: .*, (\d+)/\d+ cycles", re.M)
+COREMARK_OK = "Correct operation validated."
+# "HPM <event> : 0x<64-bit hex>", fw/coremark_port/core_portme.c
+RE_HPM = re.compile(r"^HPM (.+?)\s*: 0x([0-9a-fA-F]+)", re.M)
+
+SKIPPED = ""
+
+# recorded metrics, higher is better
+METRICS = ["dhrystones_per_sec", "dmips_mhz", "coremark_mhz"]
+
+
+# firmware variant of a configuration, benchmarks without counters ignore "hpm"
+def fw_key(bench, cfg):
+    hpm = CONFIGS[cfg].get("hpm", "") if "hpm" in BENCHES[bench] else ""
+    return (bench, CONFIGS[cfg]["arch"], hpm)
+
+
+# ELF of a benchmark, None if the build failed or SKIPPED if the sources are missing
+def build_fw(bench, arch, hpm):
+    b = BENCHES[bench]
+    src_dir = os.path.join(FW_DIR, b["dir"])
+    if not os.path.isdir(src_dir):
+        print("%s: %s isn't checked out, skipped" % (bench, src_dir))
+        return SKIPPED
+    # output directory per ISA, coremark keeps it in the port directory
+    variant = arch + ("_hpm_" + hpm if hpm else "")
+    out = "out_" + variant
+    if "port" in b:
+        out = os.path.join("..", b["port"], out)
+    log_name = os.path.join(src_dir, "build_%s.log" % variant)
+    make = b["make"] + (b["hpm"][hpm]["make"] if hpm else [])
+    with open(log_name, "w") as log:
+        ret = subprocess.call(["make", "-C", src_dir, "secondary-outputs", "DEV_ARCH=" + arch,
+                               "WORK_DIR=" + out] + make, stdout=log, stderr=log)
+    if ret != 0:
+        print("%s: %s firmware build failed, see %s" % (bench, variant, log_name))
+        return None
+    return os.path.normpath(os.path.join(src_dir, out, b["dir"] + ".elf"))
+
+
+def build_model(args):
+    cfg, tcm = args
+    run_dir = os.path.join(SIM_DIR, "run_perf_" + cfg)
+    os.makedirs(run_dir, exist_ok=True)
+    params = " ".join(CONFIGS[cfg]["params"])
+    with open(os.path.join(run_dir, "build.log"), "w") as log:
+        ret = subprocess.call(["make", "-C", run_dir, "-f", "../Makefile.main", "tb_top",
+                               "cycles=1", "gparams=" + params, "tcm=" + tcm] +
+                              CONFIGS[cfg].get("make", []),
+                              stdout=log, stderr=log)
+    if ret != 0:
+        print("%s: model build failed, see %s/build.log" % (cfg, run_dir))
+        return (cfg, None)
+    return (cfg, os.path.join(run_dir, "obj_dir", "Vtb_top"))
+
+
+# a run passes when the model exits with 0 after "Finished. Ok." and the score is
+# parsed, returns the reason of a failure or None
+def run_bench(args):
+    cfg, bench, model, elf = args
+    run_dir = os.path.join(os.path.dirname(os.path.dirname(model)), bench)
+    os.makedirs(run_dir, exist_ok=True)
+    res = subprocess.run([model, "+elf=" + elf], cwd=run_dir,
+                         stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    with open(os.path.join(run_dir, "console.log"), "w") as f:
+        f.write(res.stdout)
+    m = RE_CYCLES.search(res.stdout)
+    rec = {"cycles": int(m.group(1)) if m else 0}
+    mhz = BENCHES[bench]["hz"] / 1e6
+    if bench == "dhrystone":
+        m = RE_DHRYSTONE.search(res.stdout)
+        if m and (int(m.group(1)) > 0):
+            rec["dhrystones_per_sec"] = int(m.group(1))
+            rec["dmips"] = round(rec["dhrystones_per_sec"] / DHRYSTONE_VAX, 2)
+            rec["dmips_mhz"] = round(rec["dmips"] / mhz, 3)
+    else:
+        m = RE_COREMARK.search(res.stdout)
+        if m and (float(m.group(1)) > 0):
+            rec["coremark_mhz"] = round(float(m.group(1)) / mhz, 3)
+    error = None
+    if res.returncode != 0:
+        error = "exit code %d" % res.returncode
+    elif "Finished. Ok." not in res.stdout:
+        error = "not finished"
+    elif (bench == "coremark") and (COREMARK_OK not in res.stdout):
+        error = "coremark validation failed"
+    elif not any(key in rec for key in METRICS):
+        error = "no score"
+    elif fw_key(bench, cfg)[2]:
+        error = check_hpm(bench, fw_key(bench, cfg)[2], res.stdout, rec)
+    return (cfg, bench, error, rec)
+
+
+# every event is printed once, no counter runs longer than the simulation and
+# a benchmark can't finish without a pc change, returns the reason of a failure
+def check_hpm(bench, hpm, out, rec):
+    counts = {name: int(val, 16) for name, val in RE_HPM.findall(out)}
+    for name in BENCHES[bench]["hpm"][hpm]["events"]:
+        if name not in counts:
+            return "no HPM %s counter" % name
+        if counts[name] > rec["cycles"]:
+            return "HPM %s %d over %d cycles" % (name, counts[name], rec["cycles"])
+        rec["hpm_" + re.sub(r"\W+", "_", name)] = counts[name]
+    if counts["flush"] == 0:
+        return "HPM flush didn't count"
+    return None
+
+
+# gain of the metrics over the baseline configuration of the same run, percent
+def add_gain(rec, base):
+    for key in METRICS:
+        if (key in rec) and (base.get(key, 0) > 0):
+            rec[key + "_gain"] = round((rec[key] - base[key]) * 100.0 / base[key], 2)
+
+
+def compare(prev, rec, threshold):
+    drops = []
+    for key in METRICS:
+        if (key in rec) and (prev.get(key, 0) > 0):
+            change = (rec[key] - prev[key]) * 100.0 / prev[key]
+            if change < -threshold:
+                drops.append("%s %g -> %g (%.1f%%)" % (key, prev[key], rec[key], change))
+    return drops
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("-j", "--jobs", type=int, default=multiprocessing.cpu_count())
+    parser.add_argument("--config", nargs="+", default=list(CONFIGS.keys()), choices=CONFIGS.keys())
+    parser.add_argument("--bench", nargs="+", default=list(BENCHES.keys()), choices=BENCHES.keys())
+    # allowed drop of a metric, percent
+    parser.add_argument("--threshold", type=float, default=2.0)
+    # records the results even if they're worse
+    parser.add_argument("--accept", action="store_true")
+    parser.add_argument("--tcm", default="dpi", choices=["model", "dpi"])
+    args = parser.parse_args()
+
+    # firmware once per ISA and counters, each variant has its own output directory
+    elfs = {}
+    for key in sorted(set(fw_key(bench, cfg) for cfg in args.config for bench in args.bench)):
+        elfs[key] = build_fw(*key)
+
+    failed = 0
+    results = {cfg: {"name": cfg, "params": " ".join(CONFIGS[cfg]["params"]), "source": "perf_runner"}
+               for cfg in args.config}
+    with multiprocessing.Pool(args.jobs) as pool:
+        models = dict(pool.map(build_model, [(cfg, args.tcm) for cfg in args.config]))
+        runs = []
+        for cfg in args.config:
+            if models[cfg] is None:
+                failed += 1
+                continue
+            for bench in args.bench:
+                elf = elfs[fw_key(bench, cfg)]
+                if elf is None:
+                    # firmware build failure, reported by build_fw()
+                    failed += 1
+                elif elf != SKIPPED:
+                    runs.append((cfg, bench, models[cfg], elf))
+        for cfg, bench, error, rec in pool.imap_unordered(run_bench, runs):
+            print("%s: %-10s %s %s" % (cfg, bench, "Pass" if error is None else "Fail, " + error,
+                                       " ".join("%s=%g" % (k, v) for k, v in sorted(rec.items()))))
+            if error is not None:
+                failed += 1
+                continue
+            rec["%s_cycles" % bench] = rec.pop("cycles")
+            results[cfg].update(rec)
+
+    for cfg in args.config:
+        base = CONFIGS[cfg].get("baseline")
+        if (base is not None) and (base in results):
+            add_gain(results[cfg], results[base])
+            gains = " ".join("%s=%+g%%" % (k, v) for k, v in sorted(results[cfg].items())
+                             if k.endswith("_gain"))
+            if gains:
+                print("%s: over %s %s" % (cfg, base, gains))
+
+    data = results_db.load(RESULTS)
+    prev = {rec["name"]: rec for rec in data.get("performance", [])}
+    records = []
+    regressed = 0
+    for cfg in args.config:
+        rec = results[cfg]
+        if not any(key in rec for key in METRICS):
+            continue
+        drops = compare(prev.get(cfg, {}), rec, args.threshold)
+        for d in drops:
+            print("%s: regression, %s" % (cfg, d))
+        if drops:
+            regressed += 1
+            if not args.accept:
+                continue
+        records.append(rec)
+    results_db.merge(data, "performance", records)
+    results_db.save(RESULTS, data)
+    print("%d configurations, %d failed runs, %d regressed (threshold %.1f%%)" %
+          (len(args.config), failed, regressed, args.threshold))
+    return 1 if (failed or regressed) else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,59 @@
+#!/usr/bin/env python3
+# Shared access to results.json: records are merged by name, other sections
+# (e.g. "timings" from sim_common/results.py) are kept untouched.
+#
+# Usage: results_db.py RESULTS SECTION RECORD_JSON... - merges records written by
+# the simulation (+summary=<file>, vrf/sim_summary.h) into the section.
+
+import datetime
+import json
+import os
+import sys
+
+
+def load(file_name):
+    if not os.path.exists(file_name):
+        return {"tests": []}
+    with open(file_name) as f:
+        data = json.load(f)
+    data.setdefault("tests", [])
+    return data
+
+
+def merge(data, section, records):
+    by_name = {rec["name"]: rec for rec in data.setdefault(section, [])}
+    now = datetime.datetime.now().isoformat()
+    for rec in records:
+        rec = dict(rec)
+        rec.setdefault("last_run", now)
+        if rec["name"] in by_name:
+            by_name[rec["name"]].update(rec)
+        else:
+            data[section].append(rec)
+            by_name[rec["name"]] = rec
+
+
+def save(file_name, data):
+    tmp_name = file_name + ".tmp"
+    with open(tmp_name, "w") as f:
+        json.dump(data, f, indent=4)
+        f.write("\n")
+    os.replace(tmp_name, file_name)
+
+
+def main(argv):
+    if len(argv) < 4:
+        print("usage: %s RESULTS SECTION RECORD_JSON..." % argv[0], file=sys.stderr)
+        return 1
+    records = []
+    for file_name in argv[3:]:
+        with open(file_name) as f:
+            records.append(json.load(f))
+    data = load(argv[1])
+    merge(data, argv[2], records)
+    save(argv[1], data)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,234 @@
+#!/usr/bin/env python3
+# Decodes a binary retire trace (+trace_bin=<file>, vrf/sim_trace_bin.h) into the
+# trace.txt table of rtl/core/rv_trace.sv.
+#
+# Usage: trace_decode.py TRACE_BIN [-o trace.txt]
+
+import argparse
+import struct
+import sys
+
+MAGIC = b"RVTRACE1"
+HEADER = struct.Struct("<8sII")
+RECORD = struct.Struct("<QQIIIIIIIHBB")
+
+REC_RETIRE = 0
+REC_EVENT = 1
+REC_FINISH = 2
+
+F_REG_WRITE = 1 << 0
+F_MEM_READ = 1 << 1
+F_MEM_WRITE = 1 << 2
+
+EVENTS = {
+    1: "Reset de-asserted",
+    2: "Reset asserted",
+    3: "Trap taken",
+}
+
+LINE = "+----------+----------+----------+-------------------------------------------------------+\n"
+
+
+def bits(value, hi, lo):
+    return (value >> lo) & ((1 << (hi - lo + 1)) - 1)
+
+
+def sext(value, width):
+    sign = 1 << (width - 1)
+    return (value & (sign - 1)) - (value & sign)
+
+
+def hextoa(value):
+    return "%x" % (value & 0xffffffff)
+
+
+def reg(idx):
+    return "r%d" % idx
+
+
+def raw_bytes(value, count):
+    # string concatenation of a vector in SV, NUL characters are dropped
+    out = ""
+    for i in reversed(range(count)):
+        ch = (value >> (i * 8)) & 0xff
+        if ch != 0:
+            out += chr(ch)
+    return out
+
+
+def data_masked(data, sel):
+    nb = [hextoa(bits(data, i * 8 + 7, i * 8)) for i in range(4)]
+    if sel == 0b0001:
+        return "---" + nb[0] + "(---" + raw_bytes(data, 1) + ")"
+    if sel == 0b0010:
+        return "--" + nb[1] + "-" + "(--" + raw_bytes(data >> 8, 1) + "-)"
+    if sel == 0b0100:
+        return "-" + nb[2] + "--" + "(-" + raw_bytes(data >> 16, 1) + "--)"
+    if sel == 0b1000:
+        return nb[3] + "---" + "(" + raw_bytes(data >> 24, 1) + "---)"
+    if sel == 0b0011:
+        return "--" + hextoa(data & 0xffff) + "(--" + raw_bytes(data, 2) + ")"
+    if sel == 0b1100:
+        return hextoa(data >> 16) + "--" + "(" + raw_bytes(data >> 16, 2) + "--)"
+    if sel == 0b1111:
+        return hextoa(data) + "(" + raw_bytes(data, 4) + ")"
+    return "INVALID_SEL"
+
+
+def decode_load(instr, pc):
+    op = ["lb", "lh", "lw", "ERROR", "lbu", "lhu", "ERROR", "ERROR"][bits(instr, 14, 12)]
+    return "%s %s, %d(%s)" % (op, reg(bits(instr, 11, 7)), sext(bits(instr, 31, 20), 12),
+                              reg(bits(instr, 19, 15)))
+
+
+def decode_arif_imm(instr, pc):
+    f3 = bits(instr, 14, 12)
+    if f3 == 5:
+        op = "srai" if bits(instr, 31, 25) == 32 else "srli"
+    else:
+        op = ["addi", "slli", "slti", "sltiu", "xori", "", "ori", "andi"][f3]
+    return "%s %s, %s, %d" % (op, reg(bits(instr, 11, 7)), reg(bits(instr, 19, 15)),
+                              sext(bits(instr, 31, 20), 12))
+
+
+def decode_auipc(instr, pc):
+    return "auipc %s, 0x%s" % (reg(bits(instr, 11, 7)), hextoa((instr & 0xfffff000) + pc))
+
+
+def decode_store(instr, pc):
+    op = ["sb", "sh", "sw", "ERROR", "ERROR", "ERROR", "ERROR", "ERROR"][bits(instr, 14, 12)]
+    offset = sext((bits(instr, 31, 25) << 5) | bits(instr, 11, 7), 12)
+    return "%s %s, %d(%s)" % (op, reg(bits(instr, 24, 20)), offset, reg(bits(instr, 19, 15)))
+
+
+def decode_arif_reg(instr, pc):
+    f3 = bits(instr, 14, 12)
+    if bits(instr, 25, 25) == 0:
+        alt = bits(instr, 31, 25) == 32
+        op = [("add", "sub"), ("sll", "UNDEFINED"), ("slt", "UNDEFINED"), ("sltu", "UNDEFINED"),
+              ("xor", "UNDEFINED"), ("srl", "sra"), ("or", "UNDEFINED"), ("and", "UNDEFINED")][f3][alt]
+    else:
+        op = ["mul", "mulh", "mulhsu", "mulhu", "div", "divu", "rem", "remu"][f3]
+    return "%s %s, %s, %s" % (op, reg(bits(instr, 11, 7)), reg(bits(instr, 19, 15)),
+                              reg(bits(instr, 24, 20)))
+
+
+def decode_lui(instr, pc):
+    return "lui %s, 0x%s" % (reg(bits(instr, 11, 7)), hextoa(instr & 0xfffff000))
+
+
+def decode_branch(instr, pc):
+    op = {0: "beq", 1: "bne", 4: "blt", 5: "bge", 6: "bltu"}.get(bits(instr, 14, 12), "bgeu")
+    imm = sext((bits(instr, 31, 31) << 12) | (bits(instr, 7, 7) << 11) |
+               (bits(instr, 30, 25) << 5) | (bits(instr, 11, 8) << 1), 13)
+    return "%s %s, %s, 0x%s" % (op, reg(bits(instr, 19, 15)), reg(bits(instr, 24, 20)),
+                                hextoa(pc + imm))
+
+
+def decode_jalr(instr, pc):
+    return "jalr %s, %s, %d" % (reg(bits(instr, 11, 7)), reg(bits(instr, 19, 15)),
+                                sext(bits(instr, 31, 20), 12))
+
+
+def decode_jal(instr, pc):
+    imm = sext((bits(instr, 31, 31) << 20) | (bits(instr, 19, 12) << 12) |
+               (bits(instr, 20, 20) << 11) | (bits(instr, 30, 21) << 1), 21)
+    return "jal %s, 0x%s" % (reg(bits(instr, 11, 7)), hextoa(pc + imm))
+
+
+def decode_system(instr, pc):
+    f3 = bits(instr, 14, 12)
+    idx = bits(instr, 31, 20)
+    rd = reg(bits(instr, 11, 7))
+    if f3 == 0:
+        return {0: "ecall", 1: "ebreak", 770: "mret"}.get(idx, "UNDEFINED")
+    if f3 in (1, 2, 3):
+        op = ["", "csrrw", "csrrs", "csrrc"][f3]
+        return "%s %s, %d, %s" % (op, rd, idx, reg(bits(instr, 19, 15)))
+    op = {5: "csrrwi", 6: "csrrsi"}.get(f3, "csrrci")
+    return "%s %s, %d, %d" % (op, rd, idx, bits(instr, 19, 15))
+
+
+DECODERS = {
+    0: decode_load,
+    4: decode_arif_imm,
+    5: decode_auipc,
+    8: decode_store,
+    12: decode_arif_reg,
+    13: decode_lui,
+    24: decode_branch,
+    25: decode_jalr,
+    27: decode_jal,
+    28: decode_system,
+}
+
+
+def decode_instr(instr, pc):
+    if bits(instr, 1, 0) != 3:
+        return ""
+    decoder = DECODERS.get(bits(instr, 6, 2))
+    return decoder(instr, pc) if decoder else "----------"
+
+
+def print_event(out, time, text):
+    out.write("|%8.3fns|%10s|%10s| %-53s |\n" % (time / 1000.0, "", "", text))
+
+
+def print_retire(out, rec):
+    time, _, pc, instr, rd_old, rd_data, addr, wdata, rdata, flags, sel, _ = rec
+    reg_op = ""
+    if flags & F_REG_WRITE:
+        reg_op = "%s: 0x%s<=0x%s" % (reg(bits(instr, 11, 7)), hextoa(rd_old), hextoa(rd_data))
+    out.write("|%8.3fns|0x%08x|0x%-8s| %-24s %-28s |\n" % (time / 1000.0, pc, hextoa(instr),
+                                                        decode_instr(instr, pc), reg_op))
+    if flags & F_MEM_READ:
+        mem_op = "MemRd: 0x%s=0x%s" % (hextoa(addr), data_masked(rdata, sel))
+        out.write("|%10s|%10s|%10s| %53s |\n" % ("", "", "", mem_op))
+    if flags & F_MEM_WRITE:
+        mem_op = "MemWr: 0x%s=0x%s" % (hextoa(addr), data_masked(wdata, sel))
+        out.write("|%10s|%10s|%10s| %53s |\n" % ("", "", "", mem_op))
+
+
+def decode(data, out):
+    magic, rec_size, _ = HEADER.unpack_from(data, 0)
+    if magic != MAGIC or rec_size != RECORD.size:
+        raise ValueError("not a binary trace or record size mismatch")
+    out.write(LINE)
+    out.write("| %8s | %8s | %8s | %-53s |\n" % ("Time", "PC", "Opcode", "Instruction/Event"))
+    out.write(LINE)
+    print_event(out, 0, "Trace started.")
+    for rec in RECORD.iter_unpack(data[HEADER.size:HEADER.size + (len(data) - HEADER.size) //
+                                       RECORD.size * RECORD.size]):
+        rec_type = rec[-1]
+        if rec_type == REC_RETIRE:
+            print_retire(out, rec)
+        elif rec_type == REC_EVENT:
+            print_event(out, rec[0], EVENTS.get(rec[2], "Event %d" % rec[2]))
+        elif rec_type == REC_FINISH:
+            print_event(out, rec[0], "Trace finished.")
+            out.write(LINE)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Binary retire trace decoder")
+    parser.add_argument("trace", help="file written with +trace_bin=")
+    parser.add_argument("-o", "--output", help="text table, stdout by default")
+    args = parser.parse_args()
+
+    with open(args.trace, "rb") as f:
+        data = f.read()
+    # raw data bytes are printed as characters, same as the SV string concatenation
+    out = open(args.output, "w", encoding="latin-1") if args.output else sys.stdout
+    try:
+        decode(data, out)
+    except ValueError as e:
+        print("%s: %s" % (args.trace, e), file=sys.stderr)
+        return 1
+    finally:
+        if args.output:
+            out.close()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+// Failures kept per operation class and lane, the rest are only counted
+#define MATH_FAILS_MAX  8
+
+#define MATH_INT_MIN    0x80000000u
+
+enum MathOp
+{
+    MATH_MUL,
+    MATH_DIV,       // quotient and remainder
+    MATH_DIV_RV     // the same, RISC-V M results for a zero divisor
+};
+
+// Operation class of an arithmetic unit. Operands are drawn from a domain:
+// 'opN_bits' is 31 for operands limited to [0, 2^31). 'known' describes a known
+// bug of the unit in this class, its failures are reported but don't fail the run.
+struct MathClass
+{
+    const char* name;
+    MathOp      op;
+    bool        op1_signed;
+    bool        op2_signed;
+    uint32_t    op1_bits;
+    uint32_t    op2_bits;
+    const char* known;
+};
+
+struct MathResult
+{
+    uint64_t    mul;
+    uint32_t    div;
+    uint32_t    rem;
+};
+
+struct MathFail
+{
+    uint32_t    lane;
+    uint64_t    idx;
+    uint32_t    op1;
+    uint32_t    op2;
+    MathResult  res;
+    MathResult  exp;
+};
+
+// Per class and lane; cycles are counted from the first operation issued
+// to the last result, latency from the issue of an operation to its result.
+struct MathStats
+{
+    uint64_t                ops = 0;
+    uint64_t                fails = 0;
+    uint64_t                cycles = 0;
+    uint64_t                lat_min = UINT64_MAX;
+    uint64_t                lat_max = 0;
+    double                  seconds = 0.0;
+    std::vector<MathFail>   fail_list;
+
+    void latency(uint64_t cycles)
+    {
+        lat_min = (cycles < lat_min) ? cycles : lat_min;
+        lat_max = (cycles > lat_max) ? cycles : lat_max;
+    }
+
+    void merge(const MathStats& s)
+    {
+        ops += s.ops;
+        fails += s.fails;
+        cycles += s.cycles;
+        lat_min = (s.lat_min < lat_min) ? s.lat_min : lat_min;
+        lat_max = (s.lat_max > lat_max) ? s.lat_max : lat_max;
+        // lanes run in parallel
+        seconds = (s.seconds > seconds) ? s.seconds : seconds;
+        for (const MathFail& f : s.fail_list)
+        {
+            if (fail_list.size() < MATH_FAILS_MAX)
+            {
+                fail_list.push_back(f);
+            }
+        }
+    }
+};
+
+static inline int64_t math_operand(uint32_t op, bool is_signed)
+{
+    return is_signed ? (int64_t)(int32_t)op : (int64_t)op;
+}
+
+// The contract of the unit: a zero divisor gives zero quotient and remainder
+// (all ones and the dividend for MATH_DIV_RV), otherwise truncating division,
+// INT_MIN/-1 gives INT_MIN and 0.
+static inline MathResult math_ref(const MathClass& cls, uint32_t op1, uint32_t op2)
+{
+    MathResult res = {0, 0, 0};
+    int64_t a = math_operand(op1, cls.op1_signed);
+    int64_t b = math_operand(op2, cls.op2_signed);
+    if (cls.op == MATH_MUL)
+    {
+        res.mul = (uint64_t)a * (uint64_t)b;
+    }
+    else if (b != 0)
+    {
+        res.div = (uint32_t)(a / b);
+        res.rem = (uint32_t)(a % b);
+    }
+    else if (cls.op == MATH_DIV_RV)
+    {
+        res.div = 0xffffffff;
+        res.rem = op1;
+    }
+    return res;
+}
+
+static inline bool math_equal(const MathClass& cls, const MathResult& res, const MathResult& exp)
+{
+    if (cls.op == MATH_MUL)
+    {
+        return res.mul == exp.mul;
+    }
+    return (res.div == exp.div) && (res.rem == exp.rem);
+}
+
+// Reproducible operand pairs: the sequence depends on the seed, the lane and
+// the class only. Besides uniform random operands it draws corner values,
+// powers of two and their neighbours, INT_MIN/-1 and zero divisors.
+class MathStim
+{
+public:
+    MathStim(uint64_t seed, uint32_t lane, uint32_t cls)
+    {
+        std::seed_seq seq = {(uint32_t)seed, (uint32_t)(seed >> 32), lane, cls};
+        m_rng.seed(seq);
+    }
+
+    void next(const MathClass& cls, uint32_t& op1, uint32_t& op2)
+    {
+        uint32_t kind = m_rng() & 0x1f;
+        if (kind == 0)
+        {
+            op1 = MATH_INT_MIN;
+            op2 = 0xffffffff;
+        }
+        else if ((kind == 1) && (cls.op != MATH_MUL))
+        {
+            op1 = operand();
+            op2 = 0;
+        }
+        else
+        {
+            op1 = operand();
+            op2 = operand();
+        }
+        op1 = domain(op1, cls.op1_bits);
+        op2 = domain(op2, cls.op2_bits);
+    }
+
+private:
+    static uint32_t domain(uint32_t op, uint32_t bits)
+    {
+        return (bits < 32) ? (op & ((1u << bits) - 1)) : op;
+    }
+
+    uint32_t operand()
+    {
+        static const uint32_t corners[] = {
+            0x00000000, 0x00000001, 0x00000002, 0x00000003,
+            0x7ffffffe, 0x7fffffff, 0x80000000, 0x80000001,
+            0xfffffffe, 0xffffffff, 0x55555555, 0xaaaaaaaa
+        };
+        uint32_t r = m_rng();
+        uint32_t pow2 = 1u << (r & 0x1f);
+        switch ((r >> 5) & 0x7)
+        {
+        case 0:
+            return corners[(r >> 8) % (sizeof(corners) / sizeof(corners[0]))];
+        case 1:
+            return pow2;
+        case 2:
+            return pow2 - 1;
+        case 3:
+            return -pow2;
+        case 4:
+            return m_rng() & 0xff;
+        default:
+            return m_rng();
+        }
+    }
+
+    std::mt19937    m_rng;
+};
+
+// "mul_uu,div_su" -> classes of 'all' in the list, all of 'def' if 'list' is nullptr
+static inline std::vector<uint32_t> math_select(const MathClass* all, uint32_t count,
+                                                const char* list, const char* def)
+{
+    std::vector<uint32_t> sel;
+    std::string names = std::string(",") + ((list != nullptr) ? list : def) + ",";
+    for (uint32_t i=0 ; i<count ; ++i)
+    {
+        if (names.find(std::string(",") + all[i].name + ",") != std::string::npos)
+        {
+            sel.push_back(i);
+        }
+    }
+    return sel;
+}
+
+// Per class: operations, failures, latency and throughput in cycles/op, and host Mops/s
+static inline void math_report(const MathClass& cls, const MathStats& s)
+{
+    double cpo = (s.ops != 0) ? (double)s.cycles / s.ops : 0.0;
+    double mops = (s.seconds > 0.0) ? s.ops / s.seconds / 1e6 : 0.0;
+    printf("%-8s %12lu %8lu %7lu %7lu %10.2f %10.2f\n", cls.name, s.ops, s.fails,
+           (s.lat_min == UINT64_MAX) ? 0 : s.lat_min, s.lat_max, cpo, mops);
+    if ((cls.known != nullptr) && (s.fails != 0))
+    {
+        printf("    known failure: %s\n", cls.known);
+    }
+    for (const MathFail& f : s.fail_list)
+    {
+        if (cls.op == MATH_MUL)
+        {
+            printf("    [lane %u, #%lu] 0x%08x*0x%08x=0x%016lx, expected 0x%016lx\n",
+                   f.lane, f.idx, f.op1, f.op2, f.res.mul, f.exp.mul);
+        }
+        else
+        {
+            printf("    [lane %u, #%lu] 0x%08x/0x%08x=0x%08x(0x%08x), expected 0x%08x(0x%08x)\n",
+                   f.lane, f.idx, f.op1, f.op2, f.res.div, f.res.rem, f.exp.div, f.exp.rem);
+        }
+    }
+}
+
+static inline void math_report_head()
+{
+    printf("%-8s %12s %8s %7s %7s %10s %10s\n",
+           "class", "ops", "fails", "lat_min", "lat_max", "cycles/op", "Mops/s");
+}
@@ -11,6 +11,7 @@ module math_int
     input   wire[31:0]                  i_op2,
     output  wire[31:0]                  o_div,
     output  wire[63:0]                  o_mul,
+    output  wire                        o_mul_ready,
     output  wire[31:0]                  o_rem
 );
 
@@ -29,4 +30,7 @@ module math_int
         .o_rem                          (o_rem)
     );
 
+    // last cycle of a multiplication (or idle), o_mul holds the result after its clock edge
+    assign  o_mul_ready = u_int.mul_last;
+
 endmodule
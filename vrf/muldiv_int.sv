@@ -0,0 +1,141 @@
+`timescale 1ps/1ps
+
+`include "../rtl/rv_structs.vh"
+
+// rtl/core/math/muldiv.sv with the part of rv_alu2 which drives it: the state
+// machine, the shifted op2 and the adder closing the multiplication loop.
+// i_funct3 is the one of an M instruction. An operation is taken by the clock
+// edge with i_start and o_ready set, its results are valid in the next cycle
+// with o_ready set; a cycle without i_start latches a non-M instruction.
+module muldiv_int
+(
+    input   wire                        i_clk,
+    input   wire                        i_reset_n,
+    input   wire                        i_start,
+    input   wire[2:0]                   i_funct3,
+    input   wire[31:0]                  i_op1,
+    input   wire[31:0]                  i_op2,
+    output  wire[63:0]                  o_mul,
+    output  wire[31:0]                  o_div,
+    output  wire[31:0]                  o_rem,
+    output  wire                        o_ready
+);
+
+    logic[31:0] op1, op2;
+    logic[2:0]  funct3;
+    logic       group_mux;
+    logic       div_mux;
+    logic[5:0]  op_cnt;
+
+    alu_state_t state;
+    alu_state_t state_next;
+
+    always_comb
+    begin
+        case (state)
+        `ALU_START: state_next = i_start ? `ALU_WAIT : `ALU_START;
+        `ALU_WAIT : state_next = (((op_cnt == 6'd30) && (!div_mux)) |
+                                  ((op_cnt == 6'd32) && ( div_mux)))  ? `ALU_END : `ALU_WAIT;
+        `ALU_END  : state_next = `ALU_START;
+        default   : state_next = `ALU_START;
+        endcase
+    end
+
+    logic       ready;
+    logic       mul_op1_signed;
+    logic       mul_op2_signed_next;
+    logic       mul_op2_signed;
+    logic       div_rem_signed;
+    logic       div_signed;
+    logic       rem_signed;
+    assign      ready = (state == `ALU_START);
+    assign      mul_op1_signed = !(&funct3[1:0]);
+    assign      div_rem_signed = !funct3[0];
+    assign      div_signed = (funct3[1:0] == 2'b00);
+    assign      rem_signed = (funct3[1:0] == 2'b10);
+    assign      mul_op2_signed_next = (state_next == `ALU_END) & !funct3[1];
+
+    always_ff @(posedge i_clk)
+    begin
+        if (!i_reset_n)
+            state <= `ALU_START;
+        else
+            state <= state_next;
+        mul_op2_signed <= mul_op2_signed_next;
+    end
+
+    always_ff @(posedge i_clk)
+    begin
+        if (state == `ALU_START)
+            op_cnt <= '0;
+        else
+            op_cnt <= op_cnt + 1'b1;
+    end
+
+    always_ff @(posedge i_clk)
+    begin
+        if (ready)
+        begin
+            op1 <= i_op1;
+            op2 <= i_op2;
+            funct3 <= i_funct3;
+            group_mux <= i_start;
+            div_mux <= i_start & i_funct3[2];
+        end
+        else
+        begin
+            op2 <= div_mux ? { op2[30:0], 1'b0 } : { 1'b0, op2[31:1] };
+        end
+    end
+
+    logic[32:0] op1_mux;
+    logic[31:0] op2_mux;
+    logic[32:0] add_prev;
+    logic[31:0] mul_mod;
+    logic[32:0] add;
+
+    assign  op1_mux = group_mux ? add_prev : { 1'b0, op1 };
+    assign  op2_mux = group_mux ? mul_mod : op2;
+
+/* verilator lint_off PINCONNECTEMPTY */
+    adder
+    u_adder
+    (
+        .i_is_sub                       (mul_op2_signed),
+        .i_cmp_inverse                  (1'b0),
+        .i_op1                          (op1_mux),
+        .i_op2                          (op2_mux),
+        .o_add                          (add),
+        .o_eq                           (),
+        .o_lts                          (),
+        .o_ltu                          ()
+    );
+/* verilator lint_on PINCONNECTEMPTY */
+
+    muldiv
+    u_muldiv
+    (
+        .i_clk                          (i_clk),
+        .i_on_wait                      (state == `ALU_WAIT),
+        .i_on_end                       (state == `ALU_END),
+        .i_op1_signed                   (mul_op1_signed),
+        .i_op2_signed                   (mul_op2_signed),
+        .i_dr_signed                    (div_rem_signed),
+        .i_div_signed                   (div_signed),
+        .i_rem_signed                   (rem_signed),
+        .i_is_div                       (div_mux),
+        .i_op1                          (op1),
+        .i_op2                          (op2),
+        .i_op2_lsb                      (div_mux ? op2[31] : op2[0]),
+        .i_add                          (add),
+        .i_funct3                       (i_funct3[1:0]),
+        .o_mod                          (mul_mod),
+        .o_add_prev                     (add_prev),
+        .o_mul                          (o_mul),
+        .o_div                          (o_div),
+        .o_rem                          (o_rem)
+    );
+
+    assign  o_ready = ready;
+
+endmodule
@@ -0,0 +1,264 @@
+#pragma once
+
+#include <cstdint>
+#include "rv_iss.h"
+
+// Table-driven reference of rtl/core/rv_decode.sv for 32-bit encodings of
+// RV32IM+Zicsr+Zifencei and mret. Rows match the canonical encodings only,
+// everything else is expected to be reported as unsupported.
+
+// Control outputs of the decoder, as one vector
+#define DEC_REG_WRITE   (1u << 0)   // o_reg_write with rd != x0
+#define DEC_RES_MEM     (1u << 1)
+#define DEC_RES_PC_NEXT (1u << 2)
+#define DEC_RES_ALU     (1u << 3)
+#define DEC_OP1_PC      (1u << 4)
+#define DEC_OP2_IMM     (1u << 5)
+#define DEC_JAL         (1u << 6)
+#define DEC_JALR        (1u << 7)
+#define DEC_BRANCH      (1u << 8)
+#define DEC_STORE       (1u << 9)
+#define DEC_MRET        (1u << 10)
+#define DEC_CSR_WRITE   (1u << 11)
+#define DEC_CSR_SET     (1u << 12)
+#define DEC_CSR_CLEAR   (1u << 13)
+#define DEC_CSR_READ    (1u << 14)
+#define DEC_CSR_EBREAK  (1u << 15)
+#define DEC_ADD         (1u << 16)  // alu_ctrl.add_override
+#define DEC_OP2_INV     (1u << 17)  // alu_ctrl.op2_inverse
+#define DEC_SH_AR       (1u << 18)  // alu_ctrl.sh_ar
+#define DEC_GROUP_MUX   (1u << 19)  // alu_ctrl.group_mux
+#define DEC_DIV_MUX     (1u << 20)  // alu_ctrl.div_mux
+#define DEC_CTRL_BITS   21
+
+static const char* const rv_decode_ctrl_names[DEC_CTRL_BITS] = {
+    "reg_write", "res_mem", "res_pc_next", "res_alu", "op1_pc", "op2_imm",
+    "jal", "jalr", "branch", "store", "mret",
+    "csr_write", "csr_set", "csr_clear", "csr_read", "csr_ebreak",
+    "add", "op2_inv", "sh_ar", "group_mux", "div_mux"
+};
+
+#define DEC_CARE_ALL    ((1u << DEC_CTRL_BITS) - 1)
+#define DEC_CARE_RES    (DEC_RES_MEM | DEC_RES_PC_NEXT | DEC_RES_ALU)
+#define DEC_CARE_ALU    (DEC_ADD | DEC_OP2_INV | DEC_SH_AR)
+// instructions which don't use the ALU nor the result mux
+#define DEC_CARE_FLAGS  (DEC_CARE_ALL & ~(DEC_CARE_RES | DEC_CARE_ALU | DEC_OP1_PC | DEC_OP2_IMM))
+
+enum RvImm
+{
+    RV_IMM_NONE,
+    RV_IMM_I,
+    RV_IMM_S,
+    RV_IMM_B,
+    RV_IMM_U,
+    RV_IMM_J
+};
+
+#define RV_MASK_OPC     0x0000007f
+#define RV_MASK_F3      0x0000707f
+#define RV_MASK_F7      0xfe00707f
+#define RV_MASK_ALL     0xffffffff
+
+struct RvDecodeRow
+{
+    const char* name;
+    uint32_t    mask;
+    uint32_t    match;
+    RvImm       imm;
+    bool        rs1_zero;   // o_rs1 is x0, the field is a part of the immediate
+    uint32_t    ctrl;
+    uint32_t    care;       // compared bits of ctrl
+};
+
+#define RV_F3(f3, opc)          (((f3) << 12) | (opc))
+#define RV_F7(f7, f3, opc)      (((f7) << 25) | ((f3) << 12) | (opc))
+
+#define DEC_LOAD    (DEC_REG_WRITE | DEC_RES_MEM | DEC_OP2_IMM | DEC_ADD)
+#define DEC_STORE_  (DEC_OP2_IMM | DEC_STORE | DEC_ADD)
+#define DEC_ARI     (DEC_REG_WRITE | DEC_RES_ALU | DEC_OP2_IMM)
+#define DEC_ARR     (DEC_REG_WRITE | DEC_RES_ALU)
+#define DEC_MUL     (DEC_REG_WRITE | DEC_RES_ALU | DEC_GROUP_MUX)
+#define DEC_CSR     (DEC_REG_WRITE | DEC_RES_ALU | DEC_OP2_IMM | DEC_CSR_READ)
+#define DEC_CARE_SH (DEC_CARE_ALL & ~DEC_SH_AR)
+#define DEC_CARE_NR (DEC_CARE_ALL & ~(DEC_SH_AR | DEC_CARE_RES))
+#define DEC_CARE_J  (DEC_CARE_ALL & ~DEC_CARE_ALU)
+#define DEC_CARE_CSR (DEC_CARE_FLAGS | DEC_CARE_RES)
+// the shifter doesn't use op2_inverse, funct7[5] is sh_ar
+#define DEC_CARE_SR (DEC_CARE_ALL & ~DEC_OP2_INV)
+#define DEC_CARE_SL (DEC_CARE_ALL & ~(DEC_SH_AR | DEC_OP2_INV))
+
+static const RvDecodeRow rv_decode_table[] = {
+    {"lui",     RV_MASK_OPC, RV_OPC_LUI,                    RV_IMM_U, true,  DEC_ARI | DEC_ADD,             DEC_CARE_SH},
+    {"auipc",   RV_MASK_OPC, RV_OPC_AUIPC,                  RV_IMM_U, true,  DEC_ARI | DEC_ADD | DEC_OP1_PC, DEC_CARE_SH},
+    {"jal",     RV_MASK_OPC, RV_OPC_JAL,                    RV_IMM_J, false, DEC_REG_WRITE | DEC_RES_PC_NEXT | DEC_OP1_PC | DEC_OP2_IMM | DEC_JAL, DEC_CARE_J},
+    {"jalr",    RV_MASK_F3,  RV_F3(0, RV_OPC_JALR),         RV_IMM_I, false, DEC_REG_WRITE | DEC_RES_PC_NEXT | DEC_OP2_IMM | DEC_JALR, DEC_CARE_J},
+    {"beq",     RV_MASK_F3,  RV_F3(0, RV_OPC_BRANCH),       RV_IMM_B, false, DEC_BRANCH | DEC_OP2_INV,      DEC_CARE_NR},
+    {"bne",     RV_MASK_F3,  RV_F3(1, RV_OPC_BRANCH),       RV_IMM_B, false, DEC_BRANCH | DEC_OP2_INV,      DEC_CARE_NR},
+    {"blt",     RV_MASK_F3,  RV_F3(4, RV_OPC_BRANCH),       RV_IMM_B, false, DEC_BRANCH | DEC_OP2_INV,      DEC_CARE_NR},
+    {"bge",     RV_MASK_F3,  RV_F3(5, RV_OPC_BRANCH),       RV_IMM_B, false, DEC_BRANCH | DEC_OP2_INV,      DEC_CARE_NR},
+    {"bltu",    RV_MASK_F3,  RV_F3(6, RV_OPC_BRANCH),       RV_IMM_B, false, DEC_BRANCH | DEC_OP2_INV,      DEC_CARE_NR},
+    {"bgeu",    RV_MASK_F3,  RV_F3(7, RV_OPC_BRANCH),       RV_IMM_B, false, DEC_BRANCH | DEC_OP2_INV,      DEC_CARE_NR},
+    {"lb",      RV_MASK_F3,  RV_F3(0, RV_OPC_LOAD),         RV_IMM_I, false, DEC_LOAD,                      DEC_CARE_SH},
+    {"lh",      RV_MASK_F3,  RV_F3(1, RV_OPC_LOAD),         RV_IMM_I, false, DEC_LOAD,                      DEC_CARE_SH},
+    {"lw",      RV_MASK_F3,  RV_F3(2, RV_OPC_LOAD),         RV_IMM_I, false, DEC_LOAD,                      DEC_CARE_SH},
+    {"lbu",     RV_MASK_F3,  RV_F3(4, RV_OPC_LOAD),         RV_IMM_I, false, DEC_LOAD,                      DEC_CARE_SH},
+    {"lhu",     RV_MASK_F3,  RV_F3(5, RV_OPC_LOAD),         RV_IMM_I, false, DEC_LOAD,                      DEC_CARE_SH},
+    {"sb",      RV_MASK_F3,  RV_F3(0, RV_OPC_STORE),        RV_IMM_S, false, DEC_STORE_,                    DEC_CARE_NR},
+    {"sh",      RV_MASK_F3,  RV_F3(1, RV_OPC_STORE),        RV_IMM_S, false, DEC_STORE_,                    DEC_CARE_NR},
+    {"sw",      RV_MASK_F3,  RV_F3(2, RV_OPC_STORE),        RV_IMM_S, false, DEC_STORE_,                    DEC_CARE_NR},
+    {"addi",    RV_MASK_F3,  RV_F3(0, RV_OPC_OP_IMM),       RV_IMM_I, false, DEC_ARI,                       DEC_CARE_SH},
+    {"slti",    RV_MASK_F3,  RV_F3(2, RV_OPC_OP_IMM),       RV_IMM_I, false, DEC_ARI | DEC_OP2_INV,         DEC_CARE_SH},
+    {"sltiu",   RV_MASK_F3,  RV_F3(3, RV_OPC_OP_IMM),       RV_IMM_I, false, DEC_ARI | DEC_OP2_INV,         DEC_CARE_SH},
+    {"xori",    RV_MASK_F3,  RV_F3(4, RV_OPC_OP_IMM),       RV_IMM_I, false, DEC_ARI,                       DEC_CARE_SH},
+    {"ori",     RV_MASK_F3,  RV_F3(6, RV_OPC_OP_IMM),       RV_IMM_I, false, DEC_ARI,                       DEC_CARE_SH},
+    {"andi",    RV_MASK_F3,  RV_F3(7, RV_OPC_OP_IMM),       RV_IMM_I, false, DEC_ARI,                       DEC_CARE_SH},
+    {"slli",    RV_MASK_F7,  RV_F7(0x00, 1, RV_OPC_OP_IMM), RV_IMM_I, false, DEC_ARI,                       DEC_CARE_SL},
+    {"srli",    RV_MASK_F7,  RV_F7(0x00, 5, RV_OPC_OP_IMM), RV_IMM_I, false, DEC_ARI,                       DEC_CARE_SR},
+    {"srai",    RV_MASK_F7,  RV_F7(0x20, 5, RV_OPC_OP_IMM), RV_IMM_I, false, DEC_ARI | DEC_SH_AR,           DEC_CARE_SR},
+    {"add",     RV_MASK_F7,  RV_F7(0x00, 0, RV_OPC_OP),     RV_IMM_NONE, false, DEC_ARR,                    DEC_CARE_SH},
+    {"sub",     RV_MASK_F7,  RV_F7(0x20, 0, RV_OPC_OP),     RV_IMM_NONE, false, DEC_ARR | DEC_OP2_INV,      DEC_CARE_SH},
+    {"sll",     RV_MASK_F7,  RV_F7(0x00, 1, RV_OPC_OP),     RV_IMM_NONE, false, DEC_ARR,                    DEC_CARE_SL},
+    {"slt",     RV_MASK_F7,  RV_F7(0x00, 2, RV_OPC_OP),     RV_IMM_NONE, false, DEC_ARR | DEC_OP2_INV,      DEC_CARE_SH},
+    {"sltu",    RV_MASK_F7,  RV_F7(0x00, 3, RV_OPC_OP),     RV_IMM_NONE, false, DEC_ARR | DEC_OP2_INV,      DEC_CARE_SH},
+    {"xor",     RV_MASK_F7,  RV_F7(0x00, 4, RV_OPC_OP),     RV_IMM_NONE, false, DEC_ARR,                    DEC_CARE_SH},
+    {"srl",     RV_MASK_F7,  RV_F7(0x00, 5, RV_OPC_OP),     RV_IMM_NONE, false, DEC_ARR,                    DEC_CARE_SR},
+    {"sra",     RV_MASK_F7,  RV_F7(0x20, 5, RV_OPC_OP),     RV_IMM_NONE, false, DEC_ARR | DEC_SH_AR,        DEC_CARE_SR},
+    {"or",      RV_MASK_F7,  RV_F7(0x00, 6, RV_OPC_OP),     RV_IMM_NONE, false, DEC_ARR,                    DEC_CARE_SH},
+    {"and",     RV_MASK_F7,  RV_F7(0x00, 7, RV_OPC_OP),     RV_IMM_NONE, false, DEC_ARR,                    DEC_CARE_SH},
+    {"mul",     RV_MASK_F7,  RV_F7(0x01, 0, RV_OPC_OP),     RV_IMM_NONE, false, DEC_MUL,                    DEC_CARE_SH},
+    {"mulh",    RV_MASK_F7,  RV_F7(0x01, 1, RV_OPC_OP),     RV_IMM_NONE, false, DEC_MUL,                    DEC_CARE_SH},
+    {"mulhsu",  RV_MASK_F7,  RV_F7(0x01, 2, RV_OPC_OP),     RV_IMM_NONE, false, DEC_MUL,                    DEC_CARE_SH},
+    {"mulhu",   RV_MASK_F7,  RV_F7(0x01, 3, RV_OPC_OP),     RV_IMM_NONE, false, DEC_MUL,                    DEC_CARE_SH},
+    {"div",     RV_MASK_F7,  RV_F7(0x01, 4, RV_OPC_OP),     RV_IMM_NONE, false, DEC_MUL | DEC_DIV_MUX,      DEC_CARE_SH},
+    {"divu",    RV_MASK_F7,  RV_F7(0x01, 5, RV_OPC_OP),     RV_IMM_NONE, false, DEC_MUL | DEC_DIV_MUX,      DEC_CARE_SH},
+    {"rem",     RV_MASK_F7,  RV_F7(0x01, 6, RV_OPC_OP),     RV_IMM_NONE, false, DEC_MUL | DEC_DIV_MUX,      DEC_CARE_SH},
+    {"remu",    RV_MASK_F7,  RV_F7(0x01, 7, RV_OPC_OP),     RV_IMM_NONE, false, DEC_MUL | DEC_DIV_MUX,      DEC_CARE_SH},
+    // fm/pred/succ are ignored, rs1 and rd are reserved
+    {"fence",   0x000fffff,  RV_F3(0, RV_OPC_MISC_MEM),     RV_IMM_NONE, false, 0,                          DEC_CARE_FLAGS},
+    {"fence.i", RV_MASK_ALL, RV_F3(1, RV_OPC_MISC_MEM),     RV_IMM_NONE, false, 0,                          DEC_CARE_FLAGS},
+    {"ecall",   RV_MASK_ALL, 0x00000073,                    RV_IMM_NONE, false, 0,                          DEC_CARE_FLAGS},
+    {"ebreak",  RV_MASK_ALL, 0x00100073,                    RV_IMM_NONE, false, DEC_CSR_EBREAK,             DEC_CARE_FLAGS},
+    {"mret",    RV_MASK_ALL, 0x30200073,                    RV_IMM_NONE, false, DEC_MRET,                   DEC_CARE_FLAGS},
+    {"csrrw",   RV_MASK_F3,  RV_F3(1, RV_OPC_SYSTEM),       RV_IMM_I, false, DEC_CSR | DEC_CSR_WRITE,       DEC_CARE_CSR},
+    {"csrrs",   RV_MASK_F3,  RV_F3(2, RV_OPC_SYSTEM),       RV_IMM_I, false, DEC_CSR | DEC_CSR_SET,         DEC_CARE_CSR},
+    {"csrrc",   RV_MASK_F3,  RV_F3(3, RV_OPC_SYSTEM),       RV_IMM_I, false, DEC_CSR | DEC_CSR_CLEAR,       DEC_CARE_CSR},
+    {"csrrwi",  RV_MASK_F3,  RV_F3(5, RV_OPC_SYSTEM),       RV_IMM_I, false, DEC_CSR | DEC_CSR_WRITE,       DEC_CARE_CSR},
+    {"csrrsi",  RV_MASK_F3,  RV_F3(6, RV_OPC_SYSTEM),       RV_IMM_I, false, DEC_CSR | DEC_CSR_SET,         DEC_CARE_CSR},
+    {"csrrci",  RV_MASK_F3,  RV_F3(7, RV_OPC_SYSTEM),       RV_IMM_I, false, DEC_CSR | DEC_CSR_CLEAR,       DEC_CARE_CSR},
+};
+
+#define RV_DECODE_ROWS (sizeof(rv_decode_table) / sizeof(rv_decode_table[0]))
+
+// Outputs of the decoder for one instruction
+struct RvDecodeOut
+{
+    bool        supported;
+    uint32_t    ctrl;
+    uint32_t    imm;
+    uint32_t    rd;
+    uint32_t    rs1;
+    uint32_t    rs2;
+    uint32_t    funct3;
+    uint32_t    csr_idx;
+    uint32_t    csr_imm;
+};
+
+// Fields which differ, rv_decode_compare()
+#define DEC_DIFF_SUPPORTED  (1u << 0)
+#define DEC_DIFF_CTRL       (1u << 1)
+#define DEC_DIFF_IMM        (1u << 2)
+#define DEC_DIFF_REGS       (1u << 3)
+#define DEC_DIFF_FUNCT3     (1u << 4)
+#define DEC_DIFF_CSR        (1u << 5)
+#define DEC_DIFF_PC         (1u << 6)   // pass-through of the PC, checked by the harness
+#define DEC_DIFF_FIELDS     7
+
+static const char* const rv_decode_diff_names[DEC_DIFF_FIELDS] = {
+    "supported", "ctrl", "imm", "regs", "funct3", "csr", "pc"
+};
+
+static inline const RvDecodeRow* rv_decode_lookup(uint32_t instr)
+{
+    for (const RvDecodeRow& row : rv_decode_table)
+    {
+        if ((instr & row.mask) == row.match)
+        {
+            return &row;
+        }
+    }
+    return nullptr;
+}
+
+static inline uint32_t rv_decode_imm(uint32_t instr, RvImm imm)
+{
+    switch (imm)
+    {
+    case RV_IMM_I:
+        return rv_sext(rv_bits(instr, 31, 20), 12);
+    case RV_IMM_S:
+        return rv_sext((rv_bits(instr, 31, 25) << 5) | rv_bits(instr, 11, 7), 12);
+    case RV_IMM_B:
+        return rv_sext((rv_bits(instr, 31, 31) << 12) | (rv_bits(instr, 7, 7) << 11) |
+                       (rv_bits(instr, 30, 25) << 5) | (rv_bits(instr, 11, 8) << 1), 13);
+    case RV_IMM_U:
+        return instr & 0xfffff000;
+    case RV_IMM_J:
+        return rv_sext((rv_bits(instr, 31, 31) << 20) | (rv_bits(instr, 19, 12) << 12) |
+                       (rv_bits(instr, 20, 20) << 11) | (rv_bits(instr, 30, 21) << 1), 21);
+    default:
+        return 0;
+    }
+}
+
+// Expected outputs, 'row' is nullptr for unsupported encodings
+static inline RvDecodeOut rv_decode_ref(uint32_t instr, const RvDecodeRow* row)
+{
+    RvDecodeOut out;
+    out.supported = (row != nullptr);
+    out.ctrl = (row != nullptr) ? row->ctrl : 0;
+    out.ctrl &= (rv_bits(instr, 11, 7) != 0) ? ~0u : ~DEC_REG_WRITE;
+    out.imm = (row != nullptr) ? rv_decode_imm(instr, row->imm) : 0;
+    out.rd = rv_bits(instr, 11, 7);
+    out.rs1 = ((row != nullptr) && row->rs1_zero) ? 0 : rv_bits(instr, 19, 15);
+    out.rs2 = rv_bits(instr, 24, 20);
+    out.funct3 = rv_bits(instr, 14, 12);
+    out.csr_idx = rv_bits(instr, 31, 20);
+    out.csr_imm = rv_bits(instr, 19, 15);
+    return out;
+}
+
+// Only the support flag is compared for unsupported encodings
+static inline uint32_t rv_decode_compare(const RvDecodeRow* row, const RvDecodeOut& res,
+                                         const RvDecodeOut& exp)
+{
+    uint32_t diff = 0;
+    if (res.supported != exp.supported)
+    {
+        diff |= DEC_DIFF_SUPPORTED;
+    }
+    if (row == nullptr)
+    {
+        return diff;
+    }
+    if ((res.ctrl ^ exp.ctrl) & row->care)
+    {
+        diff |= DEC_DIFF_CTRL;
+    }
+    if ((row->imm != RV_IMM_NONE) && (res.imm != exp.imm))
+    {
+        diff |= DEC_DIFF_IMM;
+    }
+    if ((res.rd != exp.rd) || (res.rs1 != exp.rs1) || (res.rs2 != exp.rs2))
+    {
+        diff |= DEC_DIFF_REGS;
+    }
+    if (res.funct3 != exp.funct3)
+    {
+        diff |= DEC_DIFF_FUNCT3;
+    }
+    if ((res.csr_idx != exp.csr_idx) || (res.csr_imm != exp.csr_imm))
+    {
+        diff |= DEC_DIFF_CSR;
+    }
+    return diff;
+}
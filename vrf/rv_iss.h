@@ -0,0 +1,562 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Reference RV32IMC+Zicsr instruction set simulator, used as a golden model for
+// the RTL retire stream. Only machine mode without interrupts is modelled, as
+// the core implements it: ecall doesn't trap, ebreak traps with mcause=3.
+
+#define RV_OPC_LOAD     0x03
+#define RV_OPC_MISC_MEM 0x0f
+#define RV_OPC_OP_IMM   0x13
+#define RV_OPC_AUIPC    0x17
+#define RV_OPC_STORE    0x23
+#define RV_OPC_OP       0x33
+#define RV_OPC_LUI      0x37
+#define RV_OPC_BRANCH   0x63
+#define RV_OPC_JALR     0x67
+#define RV_OPC_JAL      0x6f
+#define RV_OPC_SYSTEM   0x73
+
+#define RV_CSR_MSTATUS  0x300
+#define RV_CSR_MISA     0x301
+#define RV_CSR_MIE      0x304
+#define RV_CSR_MTVEC    0x305
+#define RV_CSR_MSCRATCH 0x340
+#define RV_CSR_MEPC     0x341
+#define RV_CSR_MCAUSE   0x342
+
+#define RV_CAUSE_BREAKPOINT 3
+
+static inline uint32_t rv_bits(uint32_t val, int hi, int lo)
+{
+    return (val >> lo) & ((1u << (hi - lo + 1)) - 1);
+}
+
+static inline int32_t rv_sext(uint32_t val, int bits)
+{
+    return (int32_t)(val << (32 - bits)) >> (32 - bits);
+}
+
+static inline uint32_t rv_enc_r(uint32_t f7, uint32_t rs2, uint32_t rs1, uint32_t f3, uint32_t rd, uint32_t op)
+{
+    return (f7 << 25) | (rs2 << 20) | (rs1 << 15) | (f3 << 12) | (rd << 7) | op;
+}
+
+static inline uint32_t rv_enc_i(int32_t imm, uint32_t rs1, uint32_t f3, uint32_t rd, uint32_t op)
+{
+    return ((imm & 0xfff) << 20) | (rs1 << 15) | (f3 << 12) | (rd << 7) | op;
+}
+
+static inline uint32_t rv_enc_s(int32_t imm, uint32_t rs2, uint32_t rs1, uint32_t f3, uint32_t op)
+{
+    return (rv_bits(imm, 11, 5) << 25) | (rs2 << 20) | (rs1 << 15) | (f3 << 12) |
+        (rv_bits(imm, 4, 0) << 7) | op;
+}
+
+static inline uint32_t rv_enc_b(int32_t imm, uint32_t rs2, uint32_t rs1, uint32_t f3)
+{
+    return (rv_bits(imm, 12, 12) << 31) | (rv_bits(imm, 10, 5) << 25) | (rs2 << 20) | (rs1 << 15) |
+        (f3 << 12) | (rv_bits(imm, 4, 1) << 8) | (rv_bits(imm, 11, 11) << 7) | RV_OPC_BRANCH;
+}
+
+static inline uint32_t rv_enc_j(int32_t imm, uint32_t rd)
+{
+    return (rv_bits(imm, 20, 20) << 31) | (rv_bits(imm, 10, 1) << 21) | (rv_bits(imm, 11, 11) << 20) |
+        (rv_bits(imm, 19, 12) << 12) | (rd << 7) | RV_OPC_JAL;
+}
+
+// Expands a compressed instruction into its 32-bit equivalent, returns 0 for
+// illegal and reserved encodings.
+static inline uint32_t rv_expand_c(uint16_t c)
+{
+    uint32_t rd = rv_bits(c, 11, 7);
+    uint32_t rs2 = rv_bits(c, 6, 2);
+    uint32_t rdp = rv_bits(c, 4, 2) + 8;
+    uint32_t rs1p = rv_bits(c, 9, 7) + 8;
+    uint32_t f3 = rv_bits(c, 15, 13);
+    int32_t imm6 = rv_sext((rv_bits(c, 12, 12) << 5) | rv_bits(c, 6, 2), 6);
+    switch (c & 3)
+    {
+    case 0:
+        switch (f3)
+        {
+        case 0: // c.addi4spn
+        {
+            uint32_t imm = (rv_bits(c, 10, 7) << 6) | (rv_bits(c, 12, 11) << 4) |
+                (rv_bits(c, 5, 5) << 3) | (rv_bits(c, 6, 6) << 2);
+            return (imm == 0) ? 0 : rv_enc_i(imm, 2, 0, rdp, RV_OPC_OP_IMM);
+        }
+        case 2: // c.lw
+        {
+            uint32_t imm = (rv_bits(c, 5, 5) << 6) | (rv_bits(c, 12, 10) << 3) | (rv_bits(c, 6, 6) << 2);
+            return rv_enc_i(imm, rs1p, 2, rdp, RV_OPC_LOAD);
+        }
+        case 6: // c.sw
+        {
+            uint32_t imm = (rv_bits(c, 5, 5) << 6) | (rv_bits(c, 12, 10) << 3) | (rv_bits(c, 6, 6) << 2);
+            return rv_enc_s(imm, rdp, rs1p, 2, RV_OPC_STORE);
+        }
+        }
+        return 0;
+    case 1:
+        switch (f3)
+        {
+        case 0: // c.addi, c.nop
+            return rv_enc_i(imm6, rd, 0, rd, RV_OPC_OP_IMM);
+        case 1: // c.jal
+        case 5: // c.j
+        {
+            int32_t imm = rv_sext((rv_bits(c, 12, 12) << 11) | (rv_bits(c, 8, 8) << 10) |
+                (rv_bits(c, 10, 9) << 8) | (rv_bits(c, 6, 6) << 7) | (rv_bits(c, 7, 7) << 6) |
+                (rv_bits(c, 2, 2) << 5) | (rv_bits(c, 11, 11) << 4) | (rv_bits(c, 5, 3) << 1), 12);
+            return rv_enc_j(imm, (f3 == 1) ? 1 : 0);
+        }
+        case 2: // c.li
+            return rv_enc_i(imm6, 0, 0, rd, RV_OPC_OP_IMM);
+        case 3:
+            if (rd == 2)
+            {
+                // c.addi16sp
+                int32_t imm = rv_sext((rv_bits(c, 12, 12) << 9) | (rv_bits(c, 4, 3) << 7) |
+                    (rv_bits(c, 5, 5) << 6) | (rv_bits(c, 2, 2) << 5) | (rv_bits(c, 6, 6) << 4), 10);
+                return (imm == 0) ? 0 : rv_enc_i(imm, 2, 0, 2, RV_OPC_OP_IMM);
+            }
+            // c.lui
+            return (imm6 == 0) ? 0 : (((uint32_t)imm6 << 12) | (rd << 7) | RV_OPC_LUI);
+        case 4:
+            switch (rv_bits(c, 11, 10))
+            {
+            case 0: // c.srli
+                return rv_bits(c, 12, 12) ? 0 : rv_enc_r(0x00, rs2, rs1p, 5, rs1p, RV_OPC_OP_IMM);
+            case 1: // c.srai
+                return rv_bits(c, 12, 12) ? 0 : rv_enc_r(0x20, rs2, rs1p, 5, rs1p, RV_OPC_OP_IMM);
+            case 2: // c.andi
+                return rv_enc_i(imm6, rs1p, 7, rs1p, RV_OPC_OP_IMM);
+            }
+            if (rv_bits(c, 12, 12))
+            {
+                return 0;
+            }
+            switch (rv_bits(c, 6, 5))
+            {
+            case 0: // c.sub
+                return rv_enc_r(0x20, rdp, rs1p, 0, rs1p, RV_OPC_OP);
+            case 1: // c.xor
+                return rv_enc_r(0x00, rdp, rs1p, 4, rs1p, RV_OPC_OP);
+            case 2: // c.or
+                return rv_enc_r(0x00, rdp, rs1p, 6, rs1p, RV_OPC_OP);
+            }
+            // c.and
+            return rv_enc_r(0x00, rdp, rs1p, 7, rs1p, RV_OPC_OP);
+        case 6: // c.beqz
+        case 7: // c.bnez
+        {
+            int32_t imm = rv_sext((rv_bits(c, 12, 12) << 8) | (rv_bits(c, 6, 5) << 6) |
+                (rv_bits(c, 2, 2) << 5) | (rv_bits(c, 11, 10) << 3) | (rv_bits(c, 4, 3) << 1), 9);
+            return rv_enc_b(imm, 0, rs1p, (f3 == 6) ? 0 : 1);
+        }
+        }
+        return 0;
+    case 2:
+        switch (f3)
+        {
+        case 0: // c.slli
+            return rv_bits(c, 12, 12) ? 0 : rv_enc_r(0x00, rs2, rd, 1, rd, RV_OPC_OP_IMM);
+        case 2: // c.lwsp
+        {
+            uint32_t imm = (rv_bits(c, 3, 2) << 6) | (rv_bits(c, 12, 12) << 5) | (rv_bits(c, 6, 4) << 2);
+            return (rd == 0) ? 0 : rv_enc_i(imm, 2, 2, rd, RV_OPC_LOAD);
+        }
+        case 4:
+            if (rv_bits(c, 12, 12) == 0)
+            {
+                if (rs2 == 0)
+                {
+                    // c.jr
+                    return (rd == 0) ? 0 : rv_enc_i(0, rd, 0, 0, RV_OPC_JALR);
+                }
+                // c.mv
+                return rv_enc_r(0x00, rs2, 0, 0, rd, RV_OPC_OP);
+            }
+            if (rs2 == 0)
+            {
+                // c.ebreak, c.jalr
+                return (rd == 0) ? 0x00100073 : rv_enc_i(0, rd, 0, 1, RV_OPC_JALR);
+            }
+            // c.add
+            return rv_enc_r(0x00, rs2, rd, 0, rd, RV_OPC_OP);
+        case 6: // c.swsp
+        {
+            uint32_t imm = (rv_bits(c, 8, 7) << 6) | (rv_bits(c, 12, 9) << 2);
+            return rv_enc_s(imm, rs2, 2, 2, RV_OPC_STORE);
+        }
+        }
+        return 0;
+    }
+    return 0;
+}
+
+// Architectural effects of one executed instruction.
+struct RvIssStep
+{
+    uint32_t    pc;
+    uint32_t    instr;          // as fetched, 16 bits for compressed ones
+    uint32_t    instr32;        // expanded
+    uint32_t    rd;
+    bool        rd_write;
+    uint32_t    rd_value;
+    bool        mem_read;
+    bool        mem_write;
+    bool        mem_ext;        // access out of the ISS memory (peripherals)
+    uint32_t    mem_addr;
+    uint32_t    mem_size;
+    uint32_t    mem_wdata;
+    bool        csr_ext;        // CSR isn't modelled (counters, IDs)
+    bool        trap;
+    bool        illegal;
+};
+
+class RvIss
+{
+public:
+    RvIss(uint32_t mem_base, uint32_t mem_size)
+        : m_mem_base(mem_base)
+        , m_mem(mem_size, 0)
+    {
+        reset(mem_base);
+    }
+
+    void reset(uint32_t pc)
+    {
+        memset(m_x, 0, sizeof(m_x));
+        m_pc = pc;
+        m_mstatus = 0;
+        m_mie = 0;
+        m_mtvec = 0;
+        m_mscratch = 0;
+        m_mepc = 0;
+        m_mcause = 0;
+        m_instret = 0;
+    }
+
+    uint8_t* get_mem() { return m_mem.data(); }
+    uint32_t get_pc() const { return m_pc; }
+    void set_pc(uint32_t pc) { m_pc = pc; }
+    uint32_t get_reg(uint32_t idx) const { return m_x[idx]; }
+    void set_reg(uint32_t idx, uint32_t value) { if (idx != 0) m_x[idx] = value; }
+    uint64_t get_instret() const { return m_instret; }
+
+    // Returns false for CSRs which aren't modelled, their values are taken from the RTL.
+    bool csr_read(uint32_t csr, uint32_t& val) const
+    {
+        switch (csr)
+        {
+        case RV_CSR_MSTATUS:    val = m_mstatus; return true;
+        case RV_CSR_MIE:        val = m_mie; return true;
+        case RV_CSR_MTVEC:      val = m_mtvec; return true;
+        case RV_CSR_MSCRATCH:   val = m_mscratch; return true;
+        case RV_CSR_MEPC:       val = m_mepc; return true;
+        case RV_CSR_MCAUSE:     val = m_mcause; return true;
+        }
+        val = 0;
+        return false;
+    }
+
+    bool mem_contains(uint32_t addr, uint32_t size) const
+    {
+        return ((addr - m_mem_base) < m_mem.size()) && (size <= (m_mem.size() - (addr - m_mem_base)));
+    }
+
+    uint32_t fetch(uint32_t pc) const
+    {
+        if (!mem_contains(pc, 2))
+        {
+            return 0;
+        }
+        uint32_t instr = read_mem(pc, 2);
+        if (((instr & 3) == 3) && mem_contains(pc, 4))
+        {
+            instr = read_mem(pc, 4);
+        }
+        return instr;
+    }
+
+    void step(RvIssStep& s)
+    {
+        memset(&s, 0, sizeof(s));
+        s.pc = m_pc;
+        s.instr = fetch(m_pc);
+        bool comp = (s.instr & 3) != 3;
+        s.instr32 = comp ? rv_expand_c(s.instr) : s.instr;
+        uint32_t pc_next = m_pc + (comp ? 2 : 4);
+        uint32_t in = s.instr32;
+        uint32_t rd = rv_bits(in, 11, 7);
+        uint32_t rs1 = m_x[rv_bits(in, 19, 15)];
+        uint32_t rs2 = m_x[rv_bits(in, 24, 20)];
+        uint32_t f3 = rv_bits(in, 14, 12);
+        uint32_t f7 = rv_bits(in, 31, 25);
+        int32_t imm_i = rv_sext(rv_bits(in, 31, 20), 12);
+        int32_t imm_s = rv_sext((rv_bits(in, 31, 25) << 5) | rv_bits(in, 11, 7), 12);
+        int32_t imm_b = rv_sext((rv_bits(in, 31, 31) << 12) | (rv_bits(in, 7, 7) << 11) |
+            (rv_bits(in, 30, 25) << 5) | (rv_bits(in, 11, 8) << 1), 13);
+        int32_t imm_j = rv_sext((rv_bits(in, 31, 31) << 20) | (rv_bits(in, 19, 12) << 12) |
+            (rv_bits(in, 20, 20) << 11) | (rv_bits(in, 30, 21) << 1), 21);
+        uint32_t res = 0;
+        bool wr = false;
+
+        switch (in & 0x7f)
+        {
+        case RV_OPC_LUI:
+            res = in & 0xfffff000;
+            wr = true;
+            break;
+        case RV_OPC_AUIPC:
+            res = m_pc + (in & 0xfffff000);
+            wr = true;
+            break;
+        case RV_OPC_JAL:
+            res = pc_next;
+            wr = true;
+            pc_next = m_pc + imm_j;
+            break;
+        case RV_OPC_JALR:
+            res = pc_next;
+            wr = true;
+            pc_next = (rs1 + imm_i) & ~1u;
+            break;
+        case RV_OPC_BRANCH:
+        {
+            bool taken;
+            switch (f3)
+            {
+            case 0: taken = (rs1 == rs2); break;
+            case 1: taken = (rs1 != rs2); break;
+            case 4: taken = ((int32_t)rs1 < (int32_t)rs2); break;
+            case 5: taken = ((int32_t)rs1 >= (int32_t)rs2); break;
+            case 6: taken = (rs1 < rs2); break;
+            case 7: taken = (rs1 >= rs2); break;
+            default: s.illegal = true; taken = false; break;
+            }
+            if (taken)
+            {
+                pc_next = m_pc + imm_b;
+            }
+            break;
+        }
+        case RV_OPC_LOAD:
+        {
+            static const uint32_t sizes[8] = { 1, 2, 4, 0, 1, 2, 0, 0 };
+            s.mem_read = true;
+            s.mem_addr = rs1 + imm_i;
+            s.mem_size = sizes[f3];
+            if (s.mem_size == 0)
+            {
+                s.illegal = true;
+                break;
+            }
+            s.mem_ext = !mem_contains(s.mem_addr, s.mem_size);
+            res = s.mem_ext ? 0 : read_mem(s.mem_addr, s.mem_size);
+            if (f3 == 0)
+            {
+                res = rv_sext(res, 8);
+            }
+            else if (f3 == 1)
+            {
+                res = rv_sext(res, 16);
+            }
+            wr = true;
+            break;
+        }
+        case RV_OPC_STORE:
+            s.mem_write = true;
+            s.mem_addr = rs1 + imm_s;
+            s.mem_size = 1 << f3;
+            s.mem_wdata = rs2;
+            if (f3 > 2)
+            {
+                s.illegal = true;
+                break;
+            }
+            s.mem_ext = !mem_contains(s.mem_addr, s.mem_size);
+            if (!s.mem_ext)
+            {
+                write_mem(s.mem_addr, s.mem_size, rs2);
+            }
+            break;
+        case RV_OPC_OP_IMM:
+            wr = true;
+            switch (f3)
+            {
+            case 0: res = rs1 + imm_i; break;
+            case 1: res = rs1 << (imm_i & 0x1f); break;
+            case 2: res = ((int32_t)rs1 < imm_i) ? 1 : 0; break;
+            case 3: res = (rs1 < (uint32_t)imm_i) ? 1 : 0; break;
+            case 4: res = rs1 ^ imm_i; break;
+            case 5: res = (f7 & 0x20) ? (uint32_t)((int32_t)rs1 >> (imm_i & 0x1f)) : (rs1 >> (imm_i & 0x1f)); break;
+            case 6: res = rs1 | imm_i; break;
+            default: res = rs1 & imm_i; break;
+            }
+            break;
+        case RV_OPC_OP:
+            wr = true;
+            if (f7 == 0x01)
+            {
+                res = exec_muldiv(f3, rs1, rs2);
+                break;
+            }
+            switch (f3)
+            {
+            case 0: res = (f7 & 0x20) ? (rs1 - rs2) : (rs1 + rs2); break;
+            case 1: res = rs1 << (rs2 & 0x1f); break;
+            case 2: res = ((int32_t)rs1 < (int32_t)rs2) ? 1 : 0; break;
+            case 3: res = (rs1 < rs2) ? 1 : 0; break;
+            case 4: res = rs1 ^ rs2; break;
+            case 5: res = (f7 & 0x20) ? (uint32_t)((int32_t)rs1 >> (rs2 & 0x1f)) : (rs1 >> (rs2 & 0x1f)); break;
+            case 6: res = rs1 | rs2; break;
+            default: res = rs1 & rs2; break;
+            }
+            break;
+        case RV_OPC_MISC_MEM:
+            // fence, fence.i
+            break;
+        case RV_OPC_SYSTEM:
+            if (f3 == 0)
+            {
+                switch (rv_bits(in, 31, 20))
+                {
+                case 0x000: // ecall
+                    break;
+                case 0x001: // ebreak
+                    m_mepc = m_pc;
+                    m_mcause = RV_CAUSE_BREAKPOINT;
+                    pc_next = trap_pc();
+                    s.trap = true;
+                    break;
+                case 0x302: // mret
+                    pc_next = m_mepc;
+                    break;
+                default:
+                    s.illegal = true;
+                    break;
+                }
+            }
+            else if (f3 != 4)
+            {
+                uint32_t csr = rv_bits(in, 31, 20);
+                uint32_t src = (f3 & 4) ? rv_bits(in, 19, 15) : rs1;
+                bool csr_wr = ((f3 & 3) == 1) || (rv_bits(in, 19, 15) != 0);
+                s.csr_ext = !csr_read(csr, res);
+                wr = true;
+                if (csr_wr)
+                {
+                    switch (f3 & 3)
+                    {
+                    case 1: csr_write(csr, src); break;
+                    case 2: csr_write(csr, res | src); break;
+                    default: csr_write(csr, res & ~src); break;
+                    }
+                }
+            }
+            else
+            {
+                s.illegal = true;
+            }
+            break;
+        default:
+            s.illegal = true;
+            break;
+        }
+        if (s.instr32 == 0)
+        {
+            s.illegal = true;
+        }
+        if (wr && (rd != 0) && !s.illegal)
+        {
+            s.rd = rd;
+            s.rd_write = true;
+            s.rd_value = res;
+            m_x[rd] = res;
+        }
+        m_pc = pc_next;
+        ++m_instret;
+    }
+
+private:
+    uint32_t                m_mem_base;
+    std::vector<uint8_t>    m_mem;
+    uint32_t                m_x[32];
+    uint32_t                m_pc;
+    uint32_t                m_mstatus;
+    uint32_t                m_mie;
+    uint32_t                m_mtvec;
+    uint32_t                m_mscratch;
+    uint32_t                m_mepc;
+    uint32_t                m_mcause;
+    uint64_t                m_instret;
+
+    uint32_t read_mem(uint32_t addr, uint32_t size) const
+    {
+        uint32_t val = 0;
+        for (uint32_t i=0 ; i<size ; ++i)
+        {
+            val |= (uint32_t)m_mem[addr - m_mem_base + i] << (i * 8);
+        }
+        return val;
+    }
+
+    void write_mem(uint32_t addr, uint32_t size, uint32_t val)
+    {
+        for (uint32_t i=0 ; i<size ; ++i)
+        {
+            m_mem[addr - m_mem_base + i] = val >> (i * 8);
+        }
+    }
+
+    uint32_t trap_pc() const
+    {
+        uint32_t base = m_mtvec & ~3u;
+        return ((m_mtvec & 3) == 1) ? (base + m_mcause * 4) : base;
+    }
+
+    static uint32_t exec_muldiv(uint32_t f3, uint32_t a, uint32_t b)
+    {
+        int64_t sa = (int32_t)a;
+        int64_t sb = (int32_t)b;
+        switch (f3)
+        {
+        case 0: return a * b;
+        case 1: return (uint64_t)(sa * sb) >> 32;
+        case 2: return (uint64_t)(sa * (int64_t)(uint64_t)b) >> 32;
+        case 3: return ((uint64_t)a * b) >> 32;
+        case 4:
+            if (b == 0) return 0xffffffff;
+            if ((a == 0x80000000) && (b == 0xffffffff)) return a;
+            return (int32_t)a / (int32_t)b;
+        case 5:
+            return (b == 0) ? 0xffffffff : (a / b);
+        case 6:
+            if (b == 0) return a;
+            if ((a == 0x80000000) && (b == 0xffffffff)) return 0;
+            return (int32_t)a % (int32_t)b;
+        default:
+            return (b == 0) ? a : (a % b);
+        }
+    }
+
+    void csr_write(uint32_t csr, uint32_t val)
+    {
+        switch (csr)
+        {
+        case RV_CSR_MSTATUS:    m_mstatus = val & 0x00000008; break;
+        case RV_CSR_MIE:        m_mie = val & 0x00000888; break;
+        case RV_CSR_MTVEC:      m_mtvec = val; break;
+        case RV_CSR_MSCRATCH:   m_mscratch = val; break;
+        case RV_CSR_MEPC:       m_mepc = val & ~1u; break;
+        // interrupt flag and a 4-bit code, as rv_csr_machine keeps it
+        case RV_CSR_MCAUSE:     m_mcause = val & 0x8000000f; break;
+        }
+    }
+};
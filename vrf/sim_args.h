@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include "verilated.h"
+
+// Returns value of "+name=value" plusarg, or nullptr if it isn't present.
+static inline const char* plusarg_str(VerilatedContext* ctx, const char* name)
+{
+    const char* str = ctx->commandArgsPlusMatch(name);
+    size_t len = strlen(name);
+    if ((str[0] == '+') && (strncmp(str + 1, name, len) == 0) && (str[len + 1] == '='))
+    {
+        return str + len + 2;
+    }
+    return nullptr;
+}
+
+static inline uint64_t plusarg_u64(VerilatedContext* ctx, const char* name, uint64_t def)
+{
+    const char* str = plusarg_str(ctx, name);
+    return (str != nullptr) ? strtoull(str, nullptr, 0) : def;
+}
+
+static inline bool plusarg_flag(VerilatedContext* ctx, const char* name)
+{
+    const char* str = ctx->commandArgsPlusMatch(name);
+    return (str[0] == '+') && (strncmp(str + 1, name, strlen(name)) == 0);
+}
+
+// Same as plusarg_u64(), for use before the model and its context are created.
+static inline uint64_t argv_u64(int argc, char** argv, const char* name, uint64_t def)
+{
+    size_t len = strlen(name);
+    for (int i=1 ; i<argc ; ++i)
+    {
+        if ((argv[i][0] == '+') && (strncmp(argv[i] + 1, name, len) == 0) &&
+            (argv[i][len + 1] == '='))
+        {
+            return strtoull(argv[i] + len + 2, nullptr, 0);
+        }
+    }
+    return def;
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "sim_args.h"
+
+// NIC slave slots of vrf/tb_top.sv wrapped by sim_bus_delay, "+bus_lat_<name>=<spec>"
+#define BUS_DELAY_SLAVES 16
+static const char* const bus_delay_names[BUS_DELAY_SLAVES] = {
+    "tcm", nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr
+};
+
+// Wait states of instruction transfers per NIC slave (vrf/sim_bus_delay.sv):
+//  N                           - fixed
+//  rand:MIN:MAX                - uniform per transfer, seeded by +bus_lat_seed=N
+//  FIRST-LAST=N,...,*=N        - by address range, '*' for the rest (0 by default)
+class SimBusDelay
+{
+public:
+    SimBusDelay()
+        : m_rng(1)
+    {
+    }
+
+    void init(VerilatedContext* ctx)
+    {
+        m_rng.seed(plusarg_u64(ctx, "bus_lat_seed", 1));
+        for (int i=0 ; i<BUS_DELAY_SLAVES ; ++i)
+        {
+            if (bus_delay_names[i] == nullptr)
+            {
+                continue;
+            }
+            std::string name = std::string("bus_lat_") + bus_delay_names[i];
+            const char* spec = plusarg_str(ctx, name.c_str());
+            if ((spec != nullptr) && parse(m_slaves[i], spec))
+            {
+                printf("SIM: %s wait states '%s'\n", bus_delay_names[i], spec);
+            }
+        }
+    }
+
+    bool enabled(int slave) const
+    {
+        return m_slaves[slave & (BUS_DELAY_SLAVES - 1)].enabled;
+    }
+
+    uint32_t waits(int slave, uint32_t addr) const
+    {
+        const Slave& s = m_slaves[slave & (BUS_DELAY_SLAVES - 1)];
+        for (const Range& r : s.ranges)
+        {
+            if ((addr >= r.first) && (addr <= r.last))
+            {
+                return r.waits;
+            }
+        }
+        return s.waits;
+    }
+
+    uint32_t random(int slave)
+    {
+        const Slave& s = m_slaves[slave & (BUS_DELAY_SLAVES - 1)];
+        if (s.rand_max == 0)
+        {
+            return 0;
+        }
+        return std::uniform_int_distribution<uint32_t>(s.rand_min, s.rand_max)(m_rng);
+    }
+
+private:
+    struct Range
+    {
+        uint32_t    first;
+        uint32_t    last;
+        uint32_t    waits;
+    };
+
+    struct Slave
+    {
+        bool                enabled = false;
+        uint32_t            waits = 0;
+        uint32_t            rand_min = 0;
+        uint32_t            rand_max = 0;
+        std::vector<Range>  ranges;
+    };
+
+    static bool parse(Slave& s, const char* spec)
+    {
+        char* end;
+        if (strncmp(spec, "rand:", 5) == 0)
+        {
+            s.rand_min = strtoul(spec + 5, &end, 0);
+            s.rand_max = (*end == ':') ? strtoul(end + 1, &end, 0) : s.rand_min;
+            if (s.rand_max < s.rand_min)
+            {
+                printf("SIM: invalid wait states '%s'\n", spec);
+                return false;
+            }
+        }
+        else if (strchr(spec, '=') != nullptr)
+        {
+            const char* p = spec;
+            while (*p != '\0')
+            {
+                Range r;
+                bool rest = (*p == '*');
+                if (rest)
+                {
+                    end = (char*)p + 1;
+                }
+                else
+                {
+                    r.first = strtoul(p, &end, 0);
+                    r.last = (*end == '-') ? strtoul(end + 1, &end, 0) : r.first;
+                }
+                if (*end != '=')
+                {
+                    printf("SIM: invalid wait states '%s'\n", spec);
+                    return false;
+                }
+                r.waits = strtoul(end + 1, &end, 0);
+                if (rest)
+                {
+                    s.waits = r.waits;
+                }
+                else
+                {
+                    s.ranges.push_back(r);
+                }
+                p = (*end == ',') ? end + 1 : end;
+                if ((*end != ',') && (*end != '\0'))
+                {
+                    printf("SIM: invalid wait states '%s'\n", spec);
+                    return false;
+                }
+            }
+        }
+        else
+        {
+            s.waits = strtoul(spec, &end, 0);
+            if ((end == spec) || (*end != '\0'))
+            {
+                printf("SIM: invalid wait states '%s'\n", spec);
+                return false;
+            }
+        }
+        s.enabled = true;
+        return true;
+    }
+
+    Slave           m_slaves[BUS_DELAY_SLAVES];
+    std::mt19937    m_rng;
+};
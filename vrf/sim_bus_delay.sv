@@ -0,0 +1,69 @@
+`timescale 1ps/1ps
+
+// Simulation-only wait state injector on the ack path of a NIC slave, wait
+// states are set by the harness per slave (vrf/sim_bus_delay.h, +bus_lat_<slave>=).
+// The requester keeps its address until the ack, so the slave keeps returning
+// the data of that address. Data accesses of the core expect a fixed latency
+// and pass without wait states.
+module sim_bus_delay
+#(
+    parameter int SLAVE_ID              = 0
+)
+(
+    input   wire                        i_clk,
+    input   wire                        i_sel,
+    input   wire[31:0]                  i_addr,
+    input   wire                        i_data_req,
+    input   wire                        i_ack,
+    output  wire                        o_ack
+);
+
+    import "DPI-C" function bit bus_delay_enabled(input int slave);
+    // fixed and address dependent part
+    import "DPI-C" pure function int bus_delay_waits(input int slave, input int addr);
+    // random part, drawn once per transfer
+    import "DPI-C" function int bus_delay_random(input int slave);
+
+    bit         r_en;
+    int         r_rand;
+    int         r_count;
+    logic[31:0] r_addr;
+    logic       r_done;
+    int         waits;
+    int         count;
+    logic       pass;
+
+    always_comb
+    begin
+        waits = 0;
+        if (r_en)
+            waits = bus_delay_waits(SLAVE_ID, i_addr) + r_rand;
+    end
+
+    // cycles already spent by the transfer, an ack or a new address starts the next one
+    assign  count = (r_done | (i_addr != r_addr)) ? 0 : r_count;
+    assign  pass = i_data_req | (count >= waits);
+    assign  o_ack = i_ack & ((!r_en) | pass);
+
+    always_ff @(posedge i_clk)
+    begin
+        if (r_en & !i_data_req)
+        begin
+            r_addr <= i_addr;
+            r_done <= o_ack;
+            r_count <= count + (i_sel ? 1 : 0);
+            if (o_ack)
+                r_rand <= bus_delay_random(SLAVE_ID);
+        end
+    end
+
+    initial
+    begin
+        r_en = bus_delay_enabled(SLAVE_ID);
+        r_rand = r_en ? bus_delay_random(SLAVE_ID) : 0;
+        r_count = 0;
+        r_addr = '0;
+        r_done = '1;
+    end
+
+endmodule
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include "verilated.h"
+#include "sim_tcm.h"
+#if SIM_SAVABLE
+#include "verilated_save.h"
+#endif
+
+#define SIM_CHECKPOINT_MAGIC 0x52564350u // "RVCP"
+
+// Harness variables which have to survive a checkpoint together with the model.
+struct SimState
+{
+    uint64_t    cycle;
+    uint64_t    time;
+    uint32_t    prev_marker;
+    uint32_t    markers;
+};
+
+// Model state can be stored only when it's built with --savable (make savable=1).
+#if SIM_SAVABLE
+static inline bool sim_checkpoint_save(const char* file_name, TOP_CLASS* top, SimState& state)
+{
+    VerilatedSave os;
+    os.open(file_name);
+    if (!os.isOpen())
+    {
+        printf("SIM: unable to create checkpoint '%s'\n", file_name);
+        return false;
+    }
+    uint32_t magic = SIM_CHECKPOINT_MAGIC;
+    os << magic << state.cycle << state.time << state.prev_marker << state.markers;
+    os << *top;
+#if SIM_TCM_DPI
+    // memory of tcm_dpi lives in the harness, not in the model
+    sim_tcm_mem().save(os);
+#endif
+    os.close();
+    printf("SIM: checkpoint '%s' saved at cycle %ld\n", file_name, state.cycle);
+    return true;
+}
+
+static inline bool sim_checkpoint_restore(const char* file_name, TOP_CLASS* top, SimState& state)
+{
+    VerilatedRestore os;
+    os.open(file_name);
+    if (!os.isOpen())
+    {
+        printf("SIM: unable to open checkpoint '%s'\n", file_name);
+        return false;
+    }
+    uint32_t magic = 0;
+    os >> magic;
+    if (magic != SIM_CHECKPOINT_MAGIC)
+    {
+        printf("SIM: '%s' isn't a checkpoint file\n", file_name);
+        return false;
+    }
+    os >> state.cycle >> state.time >> state.prev_marker >> state.markers;
+    os >> *top;
+#if SIM_TCM_DPI
+    sim_tcm_mem().restore(os);
+#endif
+    os.close();
+    printf("SIM: checkpoint '%s' restored at cycle %ld\n", file_name, state.cycle);
+    return true;
+}
+#else
+static inline bool sim_checkpoint_save(const char* file_name, TOP_CLASS* top, SimState& state)
+{
+    printf("SIM: checkpoints need a savable model (make savable=1)\n");
+    return false;
+}
+
+static inline bool sim_checkpoint_restore(const char* file_name, TOP_CLASS* top, SimState& state)
+{
+    printf("SIM: checkpoints need a savable model (make savable=1)\n");
+    return false;
+}
+#endif
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+
+#define SIM_CONSOLE_BUF_SIZE 4096
+
+// Firmware console output, accumulated on the host side and flushed on
+// newline, on a full buffer and on exit. Optionally duplicated into a log file.
+class SimConsole
+{
+public:
+    SimConsole()
+        : m_log(nullptr)
+    {
+        m_buf.reserve(SIM_CONSOLE_BUF_SIZE);
+    }
+
+    ~SimConsole()
+    {
+        close();
+    }
+
+    bool open_log(const char* file_name)
+    {
+        m_log = fopen(file_name, "w");
+        if (m_log == nullptr)
+        {
+            printf("SIM: unable to create console log '%s'\n", file_name);
+            return false;
+        }
+        return true;
+    }
+
+    void put(char ch)
+    {
+        m_buf.push_back(ch);
+        if ((ch == '\n') || (m_buf.size() >= SIM_CONSOLE_BUF_SIZE))
+        {
+            flush();
+        }
+    }
+
+    void write(const char* data, size_t size)
+    {
+        for (size_t i=0 ; i<size ; ++i)
+        {
+            put(data[i]);
+        }
+    }
+
+    void flush()
+    {
+        if (m_buf.empty())
+        {
+            return;
+        }
+        fwrite(m_buf.data(), 1, m_buf.size(), stdout);
+        fflush(stdout);
+        if (m_log != nullptr)
+        {
+            fwrite(m_buf.data(), 1, m_buf.size(), m_log);
+        }
+        m_buf.clear();
+    }
+
+    void close()
+    {
+        flush();
+        if (m_log != nullptr)
+        {
+            fclose(m_log);
+            m_log = nullptr;
+        }
+    }
+
+private:
+    std::string m_buf;
+    FILE*       m_log;
+};
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include "rv_iss.h"
+#include "sim_retire.h"
+#include "sim_tcm.h"
+
+// must match IADDR_SPACE_BITS of rv_top_wb for TO_SIM
+#define COSIM_PC_BITS 22
+#define COSIM_PC_MASK ((1u << COSIM_PC_BITS) - 1)
+
+// Lockstep co-simulation: the ISS executes one instruction per RTL retirement
+// and stops simulation on the first difference in PC, rd value or store.
+// Values the ISS can't know (counters, peripheral loads) are taken from the RTL.
+class SimCosim : public RetireSink
+{
+public:
+    SimCosim()
+        : m_iss(TCM_BASE, TCM_SIZE)
+        , m_retired(0)
+        , m_trap(false)
+    {
+    }
+
+    // ISS memory is a copy of the TCM model at the reset release
+    void start(uint32_t reset_pc)
+    {
+        sim_tcm_read(TCM_BASE, m_iss.get_mem(), TCM_SIZE);
+        m_iss.reset(reset_pc);
+    }
+
+    // continues from the state of another ISS (fast-forward)
+    void start_from(const RvIss& iss)
+    {
+        m_iss = iss;
+    }
+
+    RvIss& get_iss() { return m_iss; }
+
+    int on_retire(const RetireInfo& info) override
+    {
+        ++m_retired;
+        // a trap taken by the RTL without retirement of the trapping instruction
+        if (m_trap && (((m_iss.get_pc() ^ info.pc) & COSIM_PC_MASK) != 0))
+        {
+            m_iss.step(m_step);
+            if (!m_step.trap)
+            {
+                return mismatch(info, "trap");
+            }
+        }
+        m_trap = false;
+        m_iss.step(m_step);
+        const RvIssStep& s = m_step;
+
+        if (((s.pc ^ info.pc) & COSIM_PC_MASK) != 0)
+        {
+            return mismatch(info, "PC");
+        }
+        if (s.rd_write)
+        {
+            if ((s.mem_read && s.mem_ext) || s.csr_ext)
+            {
+                m_iss.set_reg(s.rd, info.reg_data);
+            }
+            else if (!info.reg_write || (info.reg_data != s.rd_value))
+            {
+                return mismatch(info, "rd value");
+            }
+        }
+        else if (info.reg_write && (((info.instr >> 7) & 0x1f) != 0))
+        {
+            return mismatch(info, "unexpected rd write");
+        }
+        if (s.mem_write)
+        {
+            uint32_t ofs = s.mem_addr & 3;
+            uint32_t sel = ((1u << s.mem_size) - 1) << ofs;
+            uint32_t mask = 0;
+            for (int i=0 ; i<4 ; ++i)
+            {
+                mask |= ((sel >> i) & 1) ? (0xffu << (i * 8)) : 0;
+            }
+            if (!info.mem_write || (info.mem_addr != s.mem_addr) || (info.mem_sel != sel) ||
+                ((info.mem_wdata & mask) != ((s.mem_wdata << (ofs * 8)) & mask)))
+            {
+                return mismatch(info, "store");
+            }
+        }
+        return 0;
+    }
+
+    void on_event(uint64_t time, uint32_t id) override
+    {
+        (void)time;
+        if (id == RETIRE_EVENT_TRAP)
+        {
+            m_trap = true;
+        }
+    }
+
+    void finish() override
+    {
+        printf("COSIM: %ld instructions checked\n", m_retired);
+    }
+
+private:
+    RvIss       m_iss;
+    RvIssStep   m_step;
+    uint64_t    m_retired;
+    bool        m_trap;
+
+    int mismatch(const RetireInfo& info, const char* what)
+    {
+        const RvIssStep& s = m_step;
+        printf("COSIM: %s mismatch at cycle %ld, instruction #%ld\n", what, info.cycle, m_retired);
+        printf("COSIM:   RTL: pc=0x%08x instr=0x%08x rd_wr=%d rd=0x%08x mem_wr=%d addr=0x%08x data=0x%08x sel=%x\n",
+            info.pc, info.instr, info.reg_write, info.reg_data, info.mem_write, info.mem_addr,
+            info.mem_wdata, info.mem_sel);
+        printf("COSIM:   ISS: pc=0x%08x instr=0x%08x rd_wr=%d x%d=0x%08x mem_wr=%d addr=0x%08x data=0x%08x size=%d\n",
+            s.pc, s.instr, s.rd_write, s.rd, s.rd_value, s.mem_write, s.mem_addr, s.mem_wdata, s.mem_size);
+        return -1;
+    }
+};
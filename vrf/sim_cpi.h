@@ -0,0 +1,191 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include "sim_retire.h"
+
+// o_debug bits of rtl/core/rv_core.sv and rtl/rv_top_wb.sv
+#define CPI_DBG_INV_INST        (1u << 0)
+#define CPI_DBG_DATA_REQ        (1u << 1)
+#define CPI_DBG_DECODE_STALL    (1u << 2)
+#define CPI_DBG_ALU1_STALL      (1u << 3)
+#define CPI_DBG_ALU1_FLUSH      (1u << 4)
+#define CPI_DBG_ALU2_FLUSH      (1u << 5)
+#define CPI_DBG_FETCH_READY     (1u << 6)
+#define CPI_DBG_MULDIV_BUSY     (1u << 7)
+#define CPI_DBG_DATA_STALL      (1u << 8)
+#define CPI_DBG_PC_CHANGE       (1u << 9)
+#define CPI_DBG_ISSUED          (1u << 10)
+#define CPI_DBG_BUS_CONFLICT    (1u << 11)
+
+// Every cycle goes to one bucket, checked in this order:
+//  base        - an instruction retires (the retire stream of rv_trace, any instruction
+//                including branches, stores and CSR ops without a register write)
+//  muldiv      - rv_alu2 mul/div state machine is busy
+//  flush       - refill after a pc change (taken branch, jump, trap) up to the next retire
+//  load_use    - decode waits for memory data (rv_ctrl need_mem_data)
+//  bus         - fetch buffer is empty while a data access holds the bus
+//  frontend    - fetch buffer is empty
+//  other       - the rest, e.g. a CSR read waiting for a jump in alu1/alu2
+enum CpiBucket
+{
+    CPI_BASE,
+    CPI_MULDIV,
+    CPI_FLUSH,
+    CPI_LOAD_USE,
+    CPI_BUS,
+    CPI_FRONTEND,
+    CPI_OTHER,
+    CPI_BUCKETS
+};
+
+static const char* const cpi_bucket_names[CPI_BUCKETS] = {
+    "base", "muldiv", "flush", "load_use", "bus", "frontend", "other"
+};
+
+// Top-down CPI stack sampled from the o_debug bits on every rising edge, "+cpi" from
+// the reset release or "+cpi_marker=N" from the N-th firmware marker, up to the end
+// or the "+cpi_stop_marker=N" one. Retirements of the rising edge are reported by
+// rv_trace before on_cycle() of that edge.
+class SimCpi : public RetireSink
+{
+public:
+    SimCpi()
+        : m_active(false)
+        , m_enabled(false)
+        , m_start_marker(0)
+        , m_stop_marker(0)
+        , m_in_flush(false)
+        , m_retired(false)
+        , m_cycles()
+    {
+    }
+
+    void init(bool active, uint32_t start_marker, uint32_t stop_marker)
+    {
+        m_active = active;
+        m_start_marker = start_marker;
+        m_stop_marker = stop_marker;
+        m_enabled = active && (start_marker == 0);
+    }
+
+    bool is_active() const { return m_active; }
+
+    void on_marker(uint32_t marker)
+    {
+        if (m_active && (marker == m_start_marker))
+        {
+            m_enabled = true;
+        }
+        if (m_active && (marker == m_stop_marker))
+        {
+            m_enabled = false;
+        }
+    }
+
+    int on_retire(const RetireInfo& info) override
+    {
+        (void)info;
+        m_retired = true;
+        return 0;
+    }
+
+    void on_cycle(uint32_t debug)
+    {
+        bool retired = m_retired;
+        m_retired = false;
+        if (!m_enabled)
+        {
+            return;
+        }
+        CpiBucket b;
+        if (retired)
+        {
+            b = CPI_BASE;
+            m_in_flush = false;
+        }
+        else if (debug & CPI_DBG_MULDIV_BUSY)
+        {
+            b = CPI_MULDIV;
+        }
+        else if (m_in_flush)
+        {
+            b = CPI_FLUSH;
+        }
+        else if (debug & CPI_DBG_DATA_STALL)
+        {
+            b = CPI_LOAD_USE;
+        }
+        else if (!(debug & CPI_DBG_FETCH_READY))
+        {
+            b = (debug & CPI_DBG_BUS_CONFLICT) ? CPI_BUS : CPI_FRONTEND;
+        }
+        else
+        {
+            b = CPI_OTHER;
+        }
+        ++m_cycles[b];
+        if (debug & CPI_DBG_PC_CHANGE)
+        {
+            m_in_flush = true;
+        }
+    }
+
+    uint64_t get_cycles() const
+    {
+        uint64_t total = 0;
+        for (int i=0 ; i<CPI_BUCKETS ; ++i)
+        {
+            total += m_cycles[i];
+        }
+        return total;
+    }
+
+    uint64_t get_instret() const { return m_cycles[CPI_BASE]; }
+
+    void report() const
+    {
+        if (!m_active)
+        {
+            return;
+        }
+        uint64_t total = get_cycles();
+        uint64_t instret = get_instret();
+        printf("CPI stack: %lu cycles, %lu instructions, CPI %.3f\n", total, instret,
+            (instret != 0) ? (double)total / instret : 0.0);
+        for (int i=0 ; i<CPI_BUCKETS ; ++i)
+        {
+            printf("  %-10s %12lu %6.2f%% %8.3f\n", cpi_bucket_names[i], m_cycles[i],
+                (total != 0) ? m_cycles[i] * 100.0 / total : 0.0,
+                (instret != 0) ? (double)m_cycles[i] / instret : 0.0);
+        }
+    }
+
+    // "cpi_stack" object of the run summary (vrf/sim_summary.h)
+    std::string json() const
+    {
+        uint64_t instret = get_instret();
+        char buf[128];
+        std::string str = "{\n";
+        snprintf(buf, sizeof(buf), "        \"cycles\": %lu,\n        \"instret\": %lu",
+            get_cycles(), instret);
+        str += buf;
+        for (int i=0 ; i<CPI_BUCKETS ; ++i)
+        {
+            snprintf(buf, sizeof(buf), ",\n        \"%s\": %.4f", cpi_bucket_names[i],
+                (instret != 0) ? (double)m_cycles[i] / instret : 0.0);
+            str += buf;
+        }
+        return str + "\n    }";
+    }
+
+private:
+    bool        m_active;
+    bool        m_enabled;
+    uint32_t    m_start_marker;
+    uint32_t    m_stop_marker;
+    bool        m_in_flush;
+    bool        m_retired;
+    uint64_t    m_cycles[CPI_BUCKETS];
+};
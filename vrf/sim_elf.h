@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <elf.h>
+
+// Function symbol of the image, sorted by address by ElfFile::get_functions().
+struct ElfSymbol
+{
+    uint32_t    addr;
+    uint32_t    size;
+    std::string name;
+};
+
+// Minimal reader for the RV32 firmware images produced by fw/Makefile.include.
+class ElfFile
+{
+public:
+    bool load(const char* file_name)
+    {
+        FILE* f = fopen(file_name, "rb");
+        if (f == nullptr)
+        {
+            printf("ELF: unable to open '%s'\n", file_name);
+            return false;
+        }
+        fseek(f, 0, SEEK_END);
+        m_data.resize(ftell(f));
+        fseek(f, 0, SEEK_SET);
+        size_t size = fread(m_data.data(), 1, m_data.size(), f);
+        fclose(f);
+        if ((size != m_data.size()) || (size < sizeof(Elf32_Ehdr)))
+        {
+            printf("ELF: unable to read '%s'\n", file_name);
+            return false;
+        }
+
+        const Elf32_Ehdr* hdr = get_header();
+        if ((memcmp(hdr->e_ident, ELFMAG, SELFMAG) != 0) ||
+            (hdr->e_ident[EI_CLASS] != ELFCLASS32) ||
+            (hdr->e_ident[EI_DATA] != ELFDATA2LSB) ||
+            (hdr->e_machine != EM_RISCV))
+        {
+            printf("ELF: '%s' isn't a RV32 little-endian image\n", file_name);
+            return false;
+        }
+        if ((hdr->e_phoff + (size_t)hdr->e_phnum * sizeof(Elf32_Phdr)) > size)
+        {
+            printf("ELF: '%s' has broken program headers\n", file_name);
+            return false;
+        }
+        return true;
+    }
+
+    const Elf32_Ehdr* get_header() const
+    {
+        return (const Elf32_Ehdr*)m_data.data();
+    }
+
+    uint32_t get_entry() const
+    {
+        return get_header()->e_entry;
+    }
+
+    uint32_t get_segments_count() const
+    {
+        return get_header()->e_phnum;
+    }
+
+    const Elf32_Phdr* get_segment(uint32_t idx) const
+    {
+        return (const Elf32_Phdr*)(m_data.data() + get_header()->e_phoff) + idx;
+    }
+
+    const uint8_t* get_segment_data(const Elf32_Phdr* seg) const
+    {
+        if ((seg->p_offset + seg->p_filesz) > m_data.size())
+        {
+            return nullptr;
+        }
+        return m_data.data() + seg->p_offset;
+    }
+
+    // STT_FUNC and global STT_NOTYPE (assembler labels like _start) symbols of .symtab,
+    // empty for a stripped image
+    std::vector<ElfSymbol> get_functions() const
+    {
+        std::vector<ElfSymbol> syms;
+        for_each_symbol([&syms](const Elf32_Sym& sym, const char* name) {
+            uint32_t type = ELF32_ST_TYPE(sym.st_info);
+            uint32_t bind = ELF32_ST_BIND(sym.st_info);
+            if (!((type == STT_FUNC) || ((type == STT_NOTYPE) && (bind == STB_GLOBAL))) ||
+                (name[0] == '\0') || (name[0] == '$') || (name[0] == '.'))
+            {
+                return;
+            }
+            syms.push_back({sym.st_value, sym.st_size, name});
+        });
+        std::sort(syms.begin(), syms.end(), [](const ElfSymbol& a, const ElfSymbol& b) {
+            return a.addr < b.addr;
+        });
+        return syms;
+    }
+
+    // address of a symbol of any type and binding, e.g. begin_signature of arch tests
+    bool find_symbol(const char* name, uint32_t& addr) const
+    {
+        bool found = false;
+        for_each_symbol([&](const Elf32_Sym& sym, const char* sym_name) {
+            if (!found && (strcmp(sym_name, name) == 0))
+            {
+                addr = sym.st_value;
+                found = true;
+            }
+        });
+        return found;
+    }
+
+protected:
+    // defined symbols of .symtab sections with their names
+    template <typename F>
+    void for_each_symbol(F func) const
+    {
+        const Elf32_Ehdr* hdr = get_header();
+        if ((hdr->e_shoff == 0) ||
+            ((hdr->e_shoff + (size_t)hdr->e_shnum * sizeof(Elf32_Shdr)) > m_data.size()))
+        {
+            return;
+        }
+        const Elf32_Shdr* sections = (const Elf32_Shdr*)(m_data.data() + hdr->e_shoff);
+        for (uint32_t i=0 ; i<hdr->e_shnum ; ++i)
+        {
+            const Elf32_Shdr& sh = sections[i];
+            if ((sh.sh_type != SHT_SYMTAB) || (sh.sh_link >= hdr->e_shnum))
+            {
+                continue;
+            }
+            const Elf32_Shdr& str = sections[sh.sh_link];
+            if (((sh.sh_offset + sh.sh_size) > m_data.size()) ||
+                ((str.sh_offset + str.sh_size) > m_data.size()))
+            {
+                continue;
+            }
+            const Elf32_Sym* sym = (const Elf32_Sym*)(m_data.data() + sh.sh_offset);
+            const char* names = (const char*)m_data.data() + str.sh_offset;
+            for (uint32_t j=0 ; j<(sh.sh_size / sizeof(Elf32_Sym)) ; ++j)
+            {
+                if ((sym[j].st_shndx == SHN_UNDEF) || (sym[j].st_shndx >= SHN_LORESERVE) ||
+                    (sym[j].st_name >= str.sh_size))
+                {
+                    continue;
+                }
+                func(sym[j], names + sym[j].st_name);
+            }
+        }
+    }
+
+    std::vector<uint8_t>    m_data;
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include "svdpi.h"
+#include "Vtb_top__Dpi.h"
+#include "rv_iss.h"
+#include "sim_tcm.h"
+
+#define FFWD_REGS_SCOPE "TOP.tb_top.u_rv.u_core.u_regs"
+#define FFWD_FETCH_SCOPE "TOP.tb_top.u_rv.u_core.u_st1_fetch.u_addr"
+#define FFWD_CSR_SCOPE "TOP.tb_top.u_rv.g_csr.u_st3_csr.u_machine"
+
+// Called for ISS stores out of the TCM (console, exit codes), return non-zero to stop.
+typedef int (*ffwd_store_cb_t)(uint32_t addr, uint32_t data);
+
+// Fast-forward: firmware is executed by the ISS up to the sampling point, then its
+// architectural state is injected into the model, which continues cycle-accurate.
+struct SimFfwdPoint
+{
+    bool        use_pc;
+    uint32_t    pc;             // stop before N-th execution of this PC
+    uint64_t    pc_hits;
+    uint64_t    instret;        // or after this number of instructions
+};
+
+// Returns 0 when the sampling point is reached.
+static inline int sim_ffwd_run(RvIss& iss, const SimFfwdPoint& point, ffwd_store_cb_t cb)
+{
+    RvIssStep s;
+    uint64_t hits = 0;
+    while (iss.get_instret() < point.instret)
+    {
+        if (point.use_pc && (iss.get_pc() == point.pc) && (++hits == point.pc_hits))
+        {
+            break;
+        }
+        iss.step(s);
+        if (s.illegal)
+        {
+            printf("FFWD: illegal instruction 0x%08x at 0x%08x\n", s.instr, s.pc);
+            return -1;
+        }
+        if (s.mem_write && s.mem_ext && (cb != nullptr))
+        {
+            int ret = cb(s.mem_addr, s.mem_wdata);
+            if (ret != 0)
+            {
+                return ret;
+            }
+        }
+    }
+    if (point.use_pc && (hits < point.pc_hits))
+    {
+        printf("FFWD: PC 0x%08x isn't reached in %ld instructions\n", point.pc, iss.get_instret());
+        return -1;
+    }
+    printf("FFWD: %ld instructions executed, PC=0x%08x\n", iss.get_instret(), iss.get_pc());
+    return 0;
+}
+
+// Memory, registers and the reset PC, must be done before reset release.
+static inline void sim_ffwd_inject_arch(RvIss& iss)
+{
+    sim_tcm_write(TCM_BASE, iss.get_mem(), TCM_SIZE);
+    svSetScope(svGetScopeFromName(FFWD_REGS_SCOPE));
+    for (uint32_t i=1 ; i<32 ; ++i)
+    {
+        regs_write(i, iss.get_reg(i));
+    }
+    svSetScope(svGetScopeFromName(FFWD_FETCH_SCOPE));
+    fetch_set_reset_pc(iss.get_pc());
+}
+
+static inline bool sim_ffwd_core_in_reset()
+{
+    svSetScope(svGetScopeFromName(FFWD_CSR_SCOPE));
+    return csr_machine_in_reset() != 0;
+}
+
+// Machine CSRs are cleared by the reset, so they're written once the core leaves it.
+static inline void sim_ffwd_inject_csr(RvIss& iss)
+{
+    static const uint32_t csrs[] = { RV_CSR_MSTATUS, RV_CSR_MIE, RV_CSR_MTVEC, RV_CSR_MSCRATCH,
+        RV_CSR_MEPC, RV_CSR_MCAUSE };
+    svSetScope(svGetScopeFromName(FFWD_CSR_SCOPE));
+    for (uint32_t csr : csrs)
+    {
+        uint32_t val;
+        iss.csr_read(csr, val);
+        csr_machine_write(csr, val);
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "sim_console.h"
+#include "sim_tcm.h"
+
+#define SIM_MAILBOX_CHANNELS 256
+#define SIM_MAILBOX_CONSOLE 0
+
+// Host side of vrf/sim_mailbox.sv: channel 0 is the console, data of other
+// channels are appended to mailbox_<channel>.bin files.
+class SimMailbox
+{
+public:
+    SimMailbox(SimConsole* console)
+        : m_console(console)
+        , m_files(SIM_MAILBOX_CHANNELS, nullptr)
+    {
+    }
+
+    ~SimMailbox()
+    {
+        for (FILE* f : m_files)
+        {
+            if (f != nullptr)
+            {
+                fclose(f);
+            }
+        }
+    }
+
+    void xfer(uint32_t ch, uint32_t addr, uint32_t size)
+    {
+        if (!sim_tcm_contains(addr, size))
+        {
+            m_console->flush();
+            printf("SIM: mailbox block 0x%08x, %d bytes is out of TCM\n", addr, size);
+            return;
+        }
+        m_buf.resize(size);
+        sim_tcm_read(addr, m_buf.data(), size);
+        if (ch == SIM_MAILBOX_CONSOLE)
+        {
+            m_console->write((const char*)m_buf.data(), size);
+            return;
+        }
+        FILE* f = get_file(ch);
+        if (f != nullptr)
+        {
+            fwrite(m_buf.data(), 1, size, f);
+        }
+    }
+
+private:
+    SimConsole*         m_console;
+    std::vector<FILE*>  m_files;
+    std::vector<uint8_t> m_buf;
+
+    FILE* get_file(uint32_t ch)
+    {
+        if (m_files[ch] == nullptr)
+        {
+            char file_name[32];
+            snprintf(file_name, sizeof(file_name), "mailbox_%d.bin", ch);
+            m_files[ch] = fopen(file_name, "wb");
+            if (m_files[ch] == nullptr)
+            {
+                printf("SIM: unable to create '%s'\n", file_name);
+            }
+        }
+        return m_files[ch];
+    }
+};
@@ -0,0 +1,73 @@
+`timescale 1ps/1ps
+
+// Simulation-only mailbox: firmware passes a buffer (address, length) and a
+// channel, the harness copies the whole block out of the TCM model at once.
+//  0x0 - buffer address
+//  0x4 - buffer length, bytes
+//  0x8 - doorbell, (sequence << 8) | channel, see fw/common/sim.c
+module sim_mailbox
+(
+    input   wire                        i_clk,
+    input   wire                        i_dev_sel,
+    input   wire[3:2]                   i_addr,
+    input   wire                        i_write,
+    input   wire[31:0]                  i_data,
+    output  wire                        o_ack,
+    output  wire[31:0]                  o_data
+);
+
+    // the harness reads the buffer by tcm_read() exported from the TCM model
+    import "DPI-C" context function void mailbox_xfer(input int ch, input int addr, input int len);
+
+    localparam  logic[3:2] REG_ADDR     = 2'd0;
+    localparam  logic[3:2] REG_LEN      = 2'd1;
+    localparam  logic[3:2] REG_CMD      = 2'd2;
+
+    logic       r_ack;
+    logic[3:2]  r_addr;
+    logic       r_write;
+    logic[31:0] r_wdata;
+    logic[31:0] r_buf_addr;
+    logic[31:0] r_buf_len;
+    logic[31:0] r_cmd;
+
+    always_ff @(posedge i_clk)
+    begin
+        r_ack <= i_dev_sel;
+        r_addr <= i_addr;
+        r_write <= i_write;
+        r_wdata <= i_data;
+    end
+
+    // registers are written a cycle later, as TCM does, so earlier stores into
+    // the buffer are already in the memory when the doorbell is handled
+    always_ff @(posedge i_clk)
+    begin
+        if (r_write & r_ack)
+        begin
+            case (r_addr)
+            REG_ADDR: r_buf_addr <= r_wdata;
+            REG_LEN:  r_buf_len <= r_wdata;
+            REG_CMD:
+            begin
+                // bus may repeat a write, the sequence number filters duplicates
+                if (r_wdata != r_cmd)
+                    mailbox_xfer(int'(r_wdata[7:0]), r_buf_addr, r_buf_len);
+                r_cmd <= r_wdata;
+            end
+            default: ;
+            endcase
+        end
+    end
+
+    assign  o_data = (r_addr == REG_ADDR) ? r_buf_addr :
+                     (r_addr == REG_LEN)  ? r_buf_len :
+                     r_cmd;
+    assign  o_ack = r_ack;
+
+    initial
+    begin
+        r_cmd = '1;
+    end
+
+endmodule
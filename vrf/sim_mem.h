@@ -0,0 +1,208 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <memory>
+#include <vector>
+
+#define SIM_MEM_PAGE_BITS 12
+#define SIM_MEM_PAGE_SIZE (1u << SIM_MEM_PAGE_BITS)
+#define SIM_MEM_PAGE_MASK (SIM_MEM_PAGE_SIZE - 1)
+
+// Sparse memory of the harness: pages are allocated on the first non-zero write, so
+// the host footprint follows the touched part of the address space. Reads of
+// untouched pages return zeros. Addresses are byte offsets from the memory base.
+class SimMem
+{
+public:
+    SimMem(uint32_t size)
+        : m_size(size)
+        , m_pages((size + SIM_MEM_PAGE_MASK) >> SIM_MEM_PAGE_BITS)
+        , m_pages_used(0)
+    {
+    }
+
+    uint32_t get_size() const { return m_size; }
+    uint32_t get_pages_count() const { return (uint32_t)m_pages.size(); }
+    uint32_t get_pages_used() const { return m_pages_used; }
+
+    // nullptr for a page which has never been written
+    const uint8_t* get_page(uint32_t idx) const { return m_pages[idx].get(); }
+
+    uint8_t* alloc_page(uint32_t idx)
+    {
+        if (!m_pages[idx])
+        {
+            m_pages[idx].reset(new uint8_t[SIM_MEM_PAGE_SIZE]());
+            ++m_pages_used;
+        }
+        return m_pages[idx].get();
+    }
+
+    uint32_t read32(uint32_t addr) const
+    {
+        addr &= (m_size - 1) & ~3u;
+        const uint8_t* page = m_pages[addr >> SIM_MEM_PAGE_BITS].get();
+        if (page == nullptr)
+        {
+            return 0;
+        }
+        uint32_t data;
+        memcpy(&data, page + (addr & SIM_MEM_PAGE_MASK), 4);
+        return data;
+    }
+
+    // byte lanes are selected by 'sel', as on the Wishbone bus; zeros written to
+    // an untouched page (.bss clearing) don't allocate it
+    void write32(uint32_t addr, uint32_t data, uint32_t sel)
+    {
+        addr &= (m_size - 1) & ~3u;
+        uint32_t idx = addr >> SIM_MEM_PAGE_BITS;
+        if (!m_pages[idx] && ((data & lanes_mask(sel)) == 0))
+        {
+            return;
+        }
+        uint8_t* page = alloc_page(idx) + (addr & SIM_MEM_PAGE_MASK);
+        for (uint32_t i=0 ; i<4 ; ++i)
+        {
+            if (sel & (1u << i))
+            {
+                page[i] = data >> (i * 8);
+            }
+        }
+    }
+
+    // zero chunks of untouched pages aren't allocated
+    void write(uint32_t addr, const uint8_t* data, uint32_t size)
+    {
+        while (size != 0)
+        {
+            uint32_t idx = addr >> SIM_MEM_PAGE_BITS;
+            uint32_t ofs = addr & SIM_MEM_PAGE_MASK;
+            uint32_t len = ((SIM_MEM_PAGE_SIZE - ofs) < size) ? (SIM_MEM_PAGE_SIZE - ofs) : size;
+            if (m_pages[idx] || !is_zero(data, len))
+            {
+                memcpy(alloc_page(idx) + ofs, data, len);
+            }
+            addr += len;
+            data += len;
+            size -= len;
+        }
+    }
+
+    void read(uint32_t addr, uint8_t* data, uint32_t size) const
+    {
+        while (size != 0)
+        {
+            uint32_t idx = addr >> SIM_MEM_PAGE_BITS;
+            uint32_t ofs = addr & SIM_MEM_PAGE_MASK;
+            uint32_t len = ((SIM_MEM_PAGE_SIZE - ofs) < size) ? (SIM_MEM_PAGE_SIZE - ofs) : size;
+            if (m_pages[idx])
+            {
+                memcpy(data, m_pages[idx].get() + ofs, len);
+            }
+            else
+            {
+                memset(data, 0, len);
+            }
+            addr += len;
+            data += len;
+            size -= len;
+        }
+    }
+
+    // used pages only, for checkpoints (VerilatedSerialize/VerilatedDeserialize)
+    template <class OS>
+    void save(OS& os)
+    {
+        uint32_t used = m_pages_used;
+        os << used;
+        for (uint32_t i=0 ; i<m_pages.size() ; ++i)
+        {
+            if (m_pages[i])
+            {
+                os << i;
+                os.write(m_pages[i].get(), SIM_MEM_PAGE_SIZE);
+            }
+        }
+    }
+
+    template <class IS>
+    void restore(IS& is)
+    {
+        for (auto& page : m_pages)
+        {
+            page.reset();
+        }
+        m_pages_used = 0;
+        uint32_t used = 0;
+        is >> used;
+        for (uint32_t i=0 ; i<used ; ++i)
+        {
+            uint32_t idx = 0;
+            is >> idx;
+            is.read(alloc_page(idx % m_pages.size()), SIM_MEM_PAGE_SIZE);
+        }
+    }
+
+    // $readmemh format: hex words, "@<word index>" and comments
+    bool load_hex(const char* file_name)
+    {
+        FILE* f = fopen(file_name, "r");
+        if (f == nullptr)
+        {
+            printf("SIM: unable to open '%s'\n", file_name);
+            return false;
+        }
+        uint32_t idx = 0;
+        char token[64];
+        while (fscanf(f, "%63s", token) == 1)
+        {
+            if ((token[0] == '/') && (token[1] == '/'))
+            {
+                fscanf(f, "%*[^\n]");
+            }
+            else if (token[0] == '@')
+            {
+                idx = strtoul(token + 1, nullptr, 16);
+            }
+            else if (isxdigit((unsigned char)token[0]))
+            {
+                write32(idx << 2, strtoul(token, nullptr, 16), 0xf);
+                ++idx;
+            }
+        }
+        fclose(f);
+        return true;
+    }
+
+private:
+    static uint32_t lanes_mask(uint32_t sel)
+    {
+        uint32_t mask = 0;
+        for (uint32_t i=0 ; i<4 ; ++i)
+        {
+            mask |= ((sel >> i) & 1) ? (0xffu << (i * 8)) : 0;
+        }
+        return mask;
+    }
+
+    static bool is_zero(const uint8_t* data, uint32_t size)
+    {
+        for (uint32_t i=0 ; i<size ; ++i)
+        {
+            if (data[i] != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    uint32_t                                m_size;
+    std::vector<std::unique_ptr<uint8_t[]>> m_pages;
+    uint32_t                                m_pages_used;
+};
@@ -0,0 +1,257 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+#include "sim_retire.h"
+#include "sim_tcm.h"
+
+// Classes of retired instructions, decoded from the expanded 32-bit encoding.
+enum MixClass
+{
+    MIX_ALU,
+    MIX_LOAD_B,
+    MIX_LOAD_H,
+    MIX_LOAD_W,
+    MIX_STORE_B,
+    MIX_STORE_H,
+    MIX_STORE_W,
+    MIX_BRANCH_TAKEN,
+    MIX_BRANCH_NOT_TAKEN,
+    MIX_JAL,
+    MIX_JALR,
+    MIX_MUL,
+    MIX_DIV,
+    MIX_CSR,
+    MIX_SYSTEM,
+    MIX_FENCE,
+    MIX_OTHER,
+    MIX_CLASSES
+};
+
+static const char* const mix_class_names[MIX_CLASSES] = {
+    "alu", "load_b", "load_h", "load_w", "store_b", "store_h", "store_w",
+    "branch_taken", "branch_not_taken", "jal", "jalr", "mul", "div", "csr",
+    "system", "fence", "other"
+};
+
+// Dynamic instruction mix of the retire stream (+mix). Cycles since the previous
+// retirement are attributed to the retired instruction. The compressed flag is
+// taken from the TCM image at the PC, since rv_trace reports expanded encodings.
+// A branch is taken when the next retired PC isn't the fall-through one.
+// Firmware markers (sim_marker()) split the run into regions: region N follows
+// the N-th marker, e.g. 1 is the timed part of a benchmark and 2 its output.
+class SimMix : public RetireSink
+{
+public:
+    SimMix()
+        : m_region(0)
+        , m_prev_cycle(0)
+        , m_started(false)
+        , m_pending(false)
+    {
+    }
+
+    void on_marker(uint32_t marker)
+    {
+        m_region = marker;
+    }
+
+    int on_retire(const RetireInfo& info) override
+    {
+        if (!m_started)
+        {
+            m_started = true;
+            m_prev_cycle = info.cycle;
+        }
+        uint64_t cycles = info.cycle - m_prev_cycle;
+        m_prev_cycle = info.cycle;
+
+        if (m_pending)
+        {
+            m_pending = false;
+            bool taken = (info.pc != (m_branch.pc + (m_branch.compressed ? 2 : 4)));
+            count(m_branch.region, taken ? MIX_BRANCH_TAKEN : MIX_BRANCH_NOT_TAKEN,
+                m_branch.compressed, m_branch.cycles);
+        }
+
+        bool compressed = is_compressed(info.pc);
+        MixClass cls = classify(info.instr);
+        if (cls == MIX_BRANCH_TAKEN)
+        {
+            m_branch = {info.pc, m_region, compressed, cycles};
+            m_pending = true;
+        }
+        else
+        {
+            count(m_region, cls, compressed, cycles);
+        }
+        return 0;
+    }
+
+    // the direction of the last branch isn't known, it's counted as not taken
+    void finish() override
+    {
+        if (m_pending)
+        {
+            m_pending = false;
+            count(m_branch.region, MIX_BRANCH_NOT_TAKEN, m_branch.compressed, m_branch.cycles);
+        }
+    }
+
+    void report() const
+    {
+        for (const auto& r : m_regions)
+        {
+            const Region& reg = r.second;
+            printf("Instruction mix, region %u: %lu instructions (%lu compressed), %lu cycles\n",
+                r.first, reg.instret, reg.compressed, reg.cycles);
+            printf("  %-16s %12s %7s %12s %8s %6s\n", "class", "count", "count%", "compressed",
+                "cycles%", "CPI");
+            for (int c=0 ; c<MIX_CLASSES ; ++c)
+            {
+                const Entry& e = reg.classes[c];
+                if (e.count == 0)
+                {
+                    continue;
+                }
+                printf("  %-16s %12lu %6.2f%% %12lu %7.2f%% %6.2f\n", mix_class_names[c], e.count,
+                    e.count * 100.0 / reg.instret, e.compressed,
+                    (reg.cycles != 0) ? e.cycles * 100.0 / reg.cycles : 0.0,
+                    (double)e.cycles / e.count);
+            }
+        }
+    }
+
+    // "instr_mix" object of the run summary (vrf/sim_summary.h), regions by id
+    std::string json() const
+    {
+        char buf[256];
+        std::string str = "{";
+        bool first_region = true;
+        for (const auto& r : m_regions)
+        {
+            const Region& reg = r.second;
+            snprintf(buf, sizeof(buf), "%s\n        \"%u\": {\n"
+                "            \"instret\": %lu,\n"
+                "            \"compressed\": %lu,\n"
+                "            \"cycles\": %lu",
+                first_region ? "" : ",", r.first, reg.instret, reg.compressed, reg.cycles);
+            str += buf;
+            first_region = false;
+            for (int c=0 ; c<MIX_CLASSES ; ++c)
+            {
+                const Entry& e = reg.classes[c];
+                snprintf(buf, sizeof(buf), ",\n            \"%s\": "
+                    "{ \"count\": %lu, \"compressed\": %lu, \"cycles\": %lu, \"cpi\": %.3f }",
+                    mix_class_names[c], e.count, e.compressed, e.cycles,
+                    (e.count != 0) ? (double)e.cycles / e.count : 0.0);
+                str += buf;
+            }
+            str += "\n        }";
+        }
+        return str + "\n    }";
+    }
+
+private:
+    struct Entry
+    {
+        uint64_t    count;
+        uint64_t    compressed;
+        uint64_t    cycles;
+    };
+
+    struct Region
+    {
+        uint64_t    instret;
+        uint64_t    compressed;
+        uint64_t    cycles;
+        Entry       classes[MIX_CLASSES];
+    };
+
+    struct Branch
+    {
+        uint32_t    pc;
+        uint32_t    region;
+        bool        compressed;
+        uint64_t    cycles;
+    };
+
+    // MIX_BRANCH_TAKEN stands for any conditional branch, resolved by the next PC
+    static MixClass classify(uint32_t instr)
+    {
+        uint32_t funct3 = (instr >> 12) & 7;
+        switch (instr & 0x7f)
+        {
+        case 0x37:  // lui
+        case 0x17:  // auipc
+        case 0x13:  // op-imm
+            return MIX_ALU;
+        case 0x33:  // op
+            if (((instr >> 25) & 0x7f) == 1)
+            {
+                return (funct3 < 4) ? MIX_MUL : MIX_DIV;
+            }
+            return MIX_ALU;
+        case 0x03:
+            return ((funct3 & 3) == 0) ? MIX_LOAD_B : ((funct3 & 3) == 1) ? MIX_LOAD_H : MIX_LOAD_W;
+        case 0x23:
+            return ((funct3 & 3) == 0) ? MIX_STORE_B : ((funct3 & 3) == 1) ? MIX_STORE_H : MIX_STORE_W;
+        case 0x63:
+            return MIX_BRANCH_TAKEN;
+        case 0x6f:
+            return MIX_JAL;
+        case 0x67:
+            return MIX_JALR;
+        case 0x73:
+            return (funct3 != 0) ? MIX_CSR : MIX_SYSTEM;
+        case 0x0f:
+            return MIX_FENCE;
+        default:
+            return MIX_OTHER;
+        }
+    }
+
+    // instruction length by the TCM image, cached per half-word
+    bool is_compressed(uint32_t pc)
+    {
+        if (!sim_tcm_contains(pc, 2))
+        {
+            return false;
+        }
+        uint32_t idx = (pc - TCM_BASE) >> 1;
+        if (m_len.empty())
+        {
+            m_len.resize(TCM_SIZE / 2, 0);
+        }
+        if (m_len[idx] == 0)
+        {
+            uint32_t word = sim_tcm_read32(pc & ~3u);
+            uint32_t half = (pc & 2) ? (word >> 16) : word;
+            m_len[idx] = ((half & 3) == 3) ? 4 : 2;
+        }
+        return m_len[idx] == 2;
+    }
+
+    void count(uint32_t region, MixClass cls, bool compressed, uint64_t cycles)
+    {
+        Region& reg = m_regions[region];
+        Entry& e = reg.classes[cls];
+        ++e.count;
+        e.compressed += compressed ? 1 : 0;
+        e.cycles += cycles;
+        ++reg.instret;
+        reg.compressed += compressed ? 1 : 0;
+        reg.cycles += cycles;
+    }
+
+    uint32_t                    m_region;
+    uint64_t                    m_prev_cycle;
+    bool                        m_started;
+    bool                        m_pending;
+    Branch                      m_branch;
+    std::map<uint32_t, Region>  m_regions;
+    std::vector<uint8_t>        m_len;
+};
@@ -0,0 +1,267 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+#include "sim_elf.h"
+#include "sim_retire.h"
+
+// deepest shadow call stack, deeper calls are attributed to the last frame
+#define PROFILE_DEPTH_MAX   256
+#define PROFILE_TOP_DEFAULT 20
+
+// Firmware profiler fed by the retire stream. Cycles since the previous retirement
+// are attributed to the retired instruction, "stall" cycles are the ones above one
+// per instruction. Functions come from the ELF symbol table, the calling context
+// from a shadow call stack of jal/jalr retirements:
+//  call   - jal/jalr with rd = ra/t0
+//  return - jalr x0 with rs1 = ra/t0
+// With a sampling period N only every N-th cycle is attributed (weighted by N).
+class SimProfile : public RetireSink
+{
+public:
+    SimProfile()
+        : m_enabled(false)
+        , m_start_marker(0)
+        , m_period(1)
+        , m_prev_cycle(0)
+        , m_started(false)
+        , m_last_parent(0)
+        , m_last_func(0)
+        , m_last_node(0)
+        , m_total_cycles(0)
+        , m_total_stalls(0)
+        , m_total_instr(0)
+    {
+        // node 0 is the root of the calling context tree
+        m_nodes.push_back({0, 0, 0, 0, {}});
+    }
+
+    bool init(const char* elf_name, uint32_t period, uint32_t start_marker)
+    {
+        ElfFile elf;
+        if ((elf_name == nullptr) || !elf.load(elf_name))
+        {
+            printf("SIM: profiler needs the firmware ELF (+elf= or +prof_elf=)\n");
+            return false;
+        }
+        m_syms = elf.get_functions();
+        if (m_syms.empty())
+        {
+            printf("SIM: '%s' has no function symbols\n", elf_name);
+        }
+        // the last entry collects addresses out of any symbol
+        m_flat.resize(m_syms.size() + 1);
+        m_period = (period == 0) ? 1 : period;
+        m_start_marker = start_marker;
+        m_enabled = (start_marker == 0);
+        m_last_node = (uint32_t)-1;
+        return true;
+    }
+
+    void on_marker(uint32_t marker)
+    {
+        if (marker == m_start_marker)
+        {
+            m_enabled = true;
+        }
+    }
+
+    int on_retire(const RetireInfo& info) override
+    {
+        uint32_t func = lookup(info.pc);
+        uint32_t parent = m_stack.empty() ? 0 : m_stack.back();
+        uint32_t node = context(parent, func);
+
+        if (!m_started)
+        {
+            m_started = true;
+            m_prev_cycle = info.cycle;
+        }
+        uint64_t delta = info.cycle - m_prev_cycle;
+        m_prev_cycle = info.cycle;
+        if (m_enabled)
+        {
+            uint64_t cycles = delta;
+            uint64_t stalls = (delta > 1) ? (delta - 1) : 0;
+            if (m_period > 1)
+            {
+                uint64_t samples = (info.cycle / m_period) - ((info.cycle - delta) / m_period);
+                cycles = samples * m_period;
+                stalls = (delta != 0) ? (cycles * stalls / delta) : 0;
+            }
+            Entry& f = m_flat[func];
+            f.cycles += cycles;
+            f.stalls += stalls;
+            ++f.instr;
+            m_nodes[node].cycles += cycles;
+            m_nodes[node].stalls += stalls;
+            m_total_cycles += cycles;
+            m_total_stalls += stalls;
+            ++m_total_instr;
+        }
+
+        uint32_t opcode = info.instr & 0x7f;
+        uint32_t rd = (info.instr >> 7) & 0x1f;
+        uint32_t rs1 = (info.instr >> 15) & 0x1f;
+        if ((opcode == 0x6f) || (opcode == 0x67))
+        {
+            if (is_link(rd))
+            {
+                if (m_stack.size() < PROFILE_DEPTH_MAX)
+                {
+                    m_stack.push_back(node);
+                }
+            }
+            else if ((opcode == 0x67) && (rd == 0) && is_link(rs1) && !m_stack.empty())
+            {
+                m_stack.pop_back();
+            }
+        }
+        return 0;
+    }
+
+    // flat profile, top functions by cycles
+    void report(uint32_t top) const
+    {
+        std::vector<uint32_t> idx;
+        for (uint32_t i=0 ; i<m_flat.size() ; ++i)
+        {
+            if (m_flat[i].instr != 0)
+            {
+                idx.push_back(i);
+            }
+        }
+        std::sort(idx.begin(), idx.end(), [this](uint32_t a, uint32_t b) {
+            return m_flat[a].cycles > m_flat[b].cycles;
+        });
+        printf("Profile: %lu cycles, %lu stall cycles, %lu instructions\n",
+            m_total_cycles, m_total_stalls, m_total_instr);
+        printf("  %7s %12s %12s %12s %6s  %s\n", "cycles%", "cycles", "stalls", "instr", "CPI", "function");
+        for (uint32_t i=0 ; (i<idx.size()) && (i<top) ; ++i)
+        {
+            const Entry& e = m_flat[idx[i]];
+            printf("  %6.2f%% %12lu %12lu %12lu %6.2f  %s\n",
+                (m_total_cycles != 0) ? e.cycles * 100.0 / m_total_cycles : 0.0,
+                e.cycles, e.stalls, e.instr, (double)e.cycles / e.instr, func_name(idx[i]).c_str());
+        }
+    }
+
+    // folded stacks ("caller;callee cycles" per line), input of flamegraph.pl
+    bool write_folded(const char* file_name) const
+    {
+        FILE* f = fopen(file_name, "w");
+        if (f == nullptr)
+        {
+            printf("SIM: unable to create '%s'\n", file_name);
+            return false;
+        }
+        for (uint32_t i=1 ; i<m_nodes.size() ; ++i)
+        {
+            if (m_nodes[i].cycles == 0)
+            {
+                continue;
+            }
+            std::vector<uint32_t> path;
+            for (uint32_t n=i ; n!=0 ; n=m_nodes[n].parent)
+            {
+                path.push_back(m_nodes[n].func);
+            }
+            std::string line;
+            for (auto it=path.rbegin() ; it!=path.rend() ; ++it)
+            {
+                line += (line.empty() ? "" : ";") + func_name(*it);
+            }
+            fprintf(f, "%s %lu\n", line.c_str(), m_nodes[i].cycles);
+        }
+        fclose(f);
+        return true;
+    }
+
+private:
+    struct Entry
+    {
+        uint64_t    cycles;
+        uint64_t    stalls;
+        uint64_t    instr;
+    };
+
+    struct Node
+    {
+        uint32_t    parent;
+        uint32_t    func;
+        uint64_t    cycles;
+        uint64_t    stalls;
+        std::map<uint32_t, uint32_t> children;
+    };
+
+    static bool is_link(uint32_t reg)
+    {
+        return (reg == 1) || (reg == 5);
+    }
+
+    uint32_t lookup(uint32_t pc) const
+    {
+        auto it = std::upper_bound(m_syms.begin(), m_syms.end(), pc,
+            [](uint32_t addr, const ElfSymbol& s) { return addr < s.addr; });
+        if (it == m_syms.begin())
+        {
+            return (uint32_t)m_syms.size();
+        }
+        --it;
+        if ((it->size != 0) && (pc >= (it->addr + it->size)))
+        {
+            return (uint32_t)m_syms.size();
+        }
+        return (uint32_t)(it - m_syms.begin());
+    }
+
+    std::string func_name(uint32_t func) const
+    {
+        return (func < m_syms.size()) ? m_syms[func].name : std::string("[unknown]");
+    }
+
+    // node of 'func' called from 'parent', the last one is cached for straight-line code
+    uint32_t context(uint32_t parent, uint32_t func)
+    {
+        if ((parent == m_last_parent) && (func == m_last_func) && (m_last_node != (uint32_t)-1))
+        {
+            return m_last_node;
+        }
+        auto it = m_nodes[parent].children.find(func);
+        uint32_t node;
+        if (it != m_nodes[parent].children.end())
+        {
+            node = it->second;
+        }
+        else
+        {
+            node = (uint32_t)m_nodes.size();
+            m_nodes[parent].children[func] = node;
+            m_nodes.push_back({parent, func, 0, 0, {}});
+        }
+        m_last_parent = parent;
+        m_last_func = func;
+        m_last_node = node;
+        return node;
+    }
+
+    bool                    m_enabled;
+    uint32_t                m_start_marker;
+    uint32_t                m_period;
+    uint64_t                m_prev_cycle;
+    bool                    m_started;
+    uint32_t                m_last_parent;
+    uint32_t                m_last_func;
+    uint32_t                m_last_node;
+    uint64_t                m_total_cycles;
+    uint64_t                m_total_stalls;
+    uint64_t                m_total_instr;
+    std::vector<ElfSymbol>  m_syms;
+    std::vector<Entry>      m_flat;
+    std::vector<Node>       m_nodes;
+    std::vector<uint32_t>   m_stack;
+};
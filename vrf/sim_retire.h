@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "svdpi.h"
+#include "Vtb_top__Dpi.h"
+
+#define TRACE_SCOPE "TOP.tb_top.u_rv.u_core.u_trace"
+
+// pipeline state at retire, RetireInfo::flags (pipe_flags in rtl/core/rv_trace.sv)
+#define RETIRE_F_EXEC_FLUSH     (1u << 0)
+#define RETIRE_F_EXEC_STALL     (1u << 1)
+#define RETIRE_F_EXEC2_FLUSH    (1u << 2)
+#define RETIRE_F_EXEC2_STALL    (1u << 3)
+#define RETIRE_F_WRITE_FLUSH    (1u << 4)
+#define RETIRE_F_EXEC2_READY    (1u << 5)
+
+// trace_event() ids of rtl/core/rv_trace.sv
+#define RETIRE_EVENT_RESET_FALLING  1
+#define RETIRE_EVENT_RESET_RISING   2
+#define RETIRE_EVENT_TRAP           3
+
+// Instruction retired by the core, as seen by rv_trace at the write stage.
+struct RetireInfo
+{
+    uint64_t    cycle;
+    uint32_t    pc;
+    uint32_t    instr;
+    bool        reg_write;
+    uint32_t    reg_data;
+    bool        mem_read;
+    bool        mem_write;
+    uint32_t    mem_addr;
+    uint32_t    mem_wdata;
+    uint32_t    mem_rdata;
+    uint32_t    mem_sel;
+    uint64_t    time;
+    uint32_t    rd_old;
+    uint32_t    flags;
+};
+
+class RetireSink
+{
+public:
+    virtual ~RetireSink() {}
+    // return non-zero to stop simulation
+    virtual int on_retire(const RetireInfo& info) = 0;
+    virtual void on_event(uint64_t time, uint32_t id) { (void)time; (void)id; }
+    virtual void finish() {}
+};
+
+// Fans the retire stream of rv_trace out to the harness consumers. The DPI
+// calls from RTL are enabled only when at least one consumer is registered.
+class SimRetire
+{
+public:
+    SimRetire()
+        : m_status(0)
+    {
+    }
+
+    void add(RetireSink* sink)
+    {
+        m_sinks.push_back(sink);
+    }
+
+    // must be called after initial blocks have been evaluated
+    void enable()
+    {
+        svSetScope(svGetScopeFromName(TRACE_SCOPE));
+        trace_retire_enable(m_sinks.empty() ? 0 : 1);
+    }
+
+    void retire(const RetireInfo& info)
+    {
+        for (RetireSink* sink : m_sinks)
+        {
+            int ret = sink->on_retire(info);
+            if ((ret != 0) && (m_status == 0))
+            {
+                m_status = ret;
+            }
+        }
+    }
+
+    void event(uint64_t time, uint32_t id)
+    {
+        for (RetireSink* sink : m_sinks)
+        {
+            sink->on_event(time, id);
+        }
+    }
+
+    void finish()
+    {
+        for (RetireSink* sink : m_sinks)
+        {
+            sink->finish();
+        }
+    }
+
+    int get_status() const { return m_status; }
+
+private:
+    std::vector<RetireSink*>    m_sinks;
+    int                         m_status;
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include "tb.h"
+
+// Called after every rising edge of i_clk, return non-zero to stop simulation.
+typedef int (*edge_cb_t)(uint64_t cycle, TOP_CLASS* p_top);
+// Called after every evaluation of the model, e.g. to dump waveforms.
+typedef void (*eval_cb_t)(uint64_t time);
+
+// Cycle-granular run loop: the model is evaluated only on clock edges (two
+// evaluations per cycle) instead of on every time unit as TB::run_steps() does.
+class SimRun
+{
+public:
+    SimRun(TB* tb, uint64_t tick_time, edge_cb_t cb)
+        : m_top(tb->get_top())
+        , m_ctx(tb->get_context())
+        , m_half_period(tick_time / 2)
+        , m_cycle(0)
+        , m_cb(cb)
+        , m_stop(false)
+        , m_eval_cb(nullptr)
+    {
+    }
+
+    // Run up to 'count' cycles, returns callback result which stopped the run.
+    int run_cycles(uint64_t count)
+    {
+        for (uint64_t i=0 ; i<count ; ++i)
+        {
+            m_top->i_clk = 1;
+            m_top->eval();
+            if (m_eval_cb != nullptr)
+            {
+                m_eval_cb(m_ctx->time());
+            }
+            m_ctx->timeInc(m_half_period);
+            ++m_cycle;
+            int ret = m_cb(m_cycle, m_top);
+            if (ret != 0)
+            {
+                return ret;
+            }
+            m_top->i_clk = 0;
+            m_top->eval();
+            if (m_eval_cb != nullptr)
+            {
+                m_eval_cb(m_ctx->time());
+            }
+            m_ctx->timeInc(m_half_period);
+            if (m_stop)
+            {
+                m_stop = false;
+                return 0;
+            }
+        }
+        return 0;
+    }
+
+    // Ends current run_cycles() once the cycle in progress is completed.
+    void request_stop() { m_stop = true; }
+
+    void set_eval_cb(eval_cb_t cb) { m_eval_cb = cb; }
+
+    uint64_t get_cycle() const { return m_cycle; }
+    void set_cycle(uint64_t cycle) { m_cycle = cycle; }
+
+private:
+    TOP_CLASS*          m_top;
+    VerilatedContext*   m_ctx;
+    uint64_t            m_half_period;
+    uint64_t            m_cycle;
+    edge_cb_t           m_cb;
+    bool                m_stop;
+    eval_cb_t           m_eval_cb;
+};
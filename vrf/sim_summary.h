@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+#include "svdpi.h"
+#include "Vtb_top__Dpi.h"
+
+#define CNTR_SCOPE "TOP.tb_top.u_rv.g_csr.u_st3_csr.g_cntr.u_cntr"
+
+// csr_cntr_read() index, rtl/csr/rv_csr_cntr.sv
+#define CNTR_CYCLE      0
+#define CNTR_INSTRET    2
+
+// Host time of the simulation phases, in seconds.
+struct SimPhases
+{
+    double      construct;
+    double      load;
+    double      reset;
+    double      run;
+};
+
+// Machine-readable result of a run (+summary=<file>), one record for
+// sim/results_db.py: "results_db.py results.json performance <file>".
+struct SimSummary
+{
+    std::string name;
+    std::string status;
+    uint64_t    cycles;         // cycles of the run phase
+    uint64_t    core_cycles;    // mcycle, since the reset release
+    uint64_t    instret;        // minstret, 0 without Zicntr
+    SimPhases   phases;
+    // optional objects of the harness reports (e.g. "cpi_stack"), name and JSON value
+    std::vector<std::pair<std::string, std::string>> sections;
+};
+
+// Counters of the core, false when the CSR unit is built without them.
+static inline bool sim_cntr_read(uint32_t idx, uint64_t& value)
+{
+    svScope scope = svGetScopeFromName(CNTR_SCOPE);
+    if (scope == nullptr)
+    {
+        return false;
+    }
+    svSetScope(scope);
+    value = (uint64_t)csr_cntr_read(idx);
+    return true;
+}
+
+static inline bool sim_summary_write(const char* file_name, const SimSummary& sum)
+{
+    FILE* f = fopen(file_name, "w");
+    if (f == nullptr)
+    {
+        printf("SIM: unable to create summary '%s'\n", file_name);
+        return false;
+    }
+    double ipc = (sum.core_cycles != 0) ? (double)sum.instret / sum.core_cycles : 0.0;
+    double cycles_per_s = (sum.phases.run > 0.0) ? sum.cycles / sum.phases.run : 0.0;
+    double kips = (sum.phases.run > 0.0) ? sum.instret / sum.phases.run / 1000.0 : 0.0;
+    fprintf(f, "{\n");
+    fprintf(f, "    \"name\": \"%s\",\n", sum.name.c_str());
+    fprintf(f, "    \"status\": \"%s\",\n", sum.status.c_str());
+    fprintf(f, "    \"cycles\": %lu,\n", sum.cycles);
+    fprintf(f, "    \"core_cycles\": %lu,\n", sum.core_cycles);
+    fprintf(f, "    \"instret\": %lu,\n", sum.instret);
+    fprintf(f, "    \"ipc\": %.4f,\n", ipc);
+    fprintf(f, "    \"cycles_per_s\": %.0f,\n", cycles_per_s);
+    fprintf(f, "    \"kips\": %.1f,\n", kips);
+    for (const auto& sec : sum.sections)
+    {
+        fprintf(f, "    \"%s\": %s,\n", sec.first.c_str(), sec.second.c_str());
+    }
+    fprintf(f, "    \"phases\": {\n");
+    fprintf(f, "        \"construct\": %.6f,\n", sum.phases.construct);
+    fprintf(f, "        \"load\": %.6f,\n", sum.phases.load);
+    fprintf(f, "        \"reset\": %.6f,\n", sum.phases.reset);
+    fprintf(f, "        \"run\": %.6f\n", sum.phases.run);
+    fprintf(f, "    }\n");
+    fprintf(f, "}\n");
+    fclose(f);
+    return true;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include "svdpi.h"
+#include "Vtb_top__Dpi.h"
+#if SIM_TCM_DPI
+#include "sim_mem.h"
+#endif
+
+// must match TO_SIM `TCM_ADDR_WIDTH from rtl/rv_defines.vh
+#define TCM_ADDR_WIDTH 21
+#define TCM_BASE 0x00000000u
+#define TCM_SIZE (4u << TCM_ADDR_WIDTH)
+#define TCM_SCOPE "TOP.tb_top.u_tcm"
+
+// Backdoor access to the TCM model, via DPI functions exported from tcm.sv,
+// or directly to the harness memory of vrf/tcm_dpi.sv (make tcm=dpi).
+
+static inline bool sim_tcm_contains(uint32_t addr, uint32_t size)
+{
+    return ((addr - TCM_BASE) < TCM_SIZE) && (size <= (TCM_SIZE - (addr - TCM_BASE)));
+}
+
+#if SIM_TCM_DPI
+static inline SimMem& sim_tcm_mem()
+{
+    static SimMem mem(TCM_SIZE);
+    return mem;
+}
+
+static inline uint32_t sim_tcm_read32(uint32_t addr)
+{
+    return sim_tcm_mem().read32(addr - TCM_BASE);
+}
+
+static inline void sim_tcm_write32(uint32_t addr, uint32_t data)
+{
+    sim_tcm_mem().write32(addr - TCM_BASE, data, 0xf);
+}
+
+static inline void sim_tcm_write(uint32_t addr, const uint8_t* data, uint32_t size)
+{
+    sim_tcm_mem().write(addr - TCM_BASE, data, size);
+}
+
+static inline void sim_tcm_read(uint32_t addr, uint8_t* data, uint32_t size)
+{
+    sim_tcm_mem().read(addr - TCM_BASE, data, size);
+}
+#else
+
+static inline void sim_tcm_scope()
+{
+    static svScope scope = svGetScopeFromName(TCM_SCOPE);
+    svSetScope(scope);
+}
+
+static inline uint32_t sim_tcm_read32(uint32_t addr)
+{
+    sim_tcm_scope();
+    return tcm_read((addr - TCM_BASE) >> 2);
+}
+
+static inline void sim_tcm_write32(uint32_t addr, uint32_t data)
+{
+    sim_tcm_scope();
+    tcm_write((addr - TCM_BASE) >> 2, data);
+}
+
+static inline void sim_tcm_write(uint32_t addr, const uint8_t* data, uint32_t size)
+{
+    sim_tcm_scope();
+    while (size != 0)
+    {
+        uint32_t idx = (addr - TCM_BASE) >> 2;
+        uint32_t ofs = addr & 3;
+        uint32_t len = ((4 - ofs) < size) ? (4 - ofs) : size;
+        uint32_t word = 0;
+        if (len != 4)
+        {
+            word = tcm_read(idx);
+        }
+        for (uint32_t i=0 ; i<len ; ++i)
+        {
+            word &= ~(0xffu << ((ofs + i) * 8));
+            word |= (uint32_t)data[i] << ((ofs + i) * 8);
+        }
+        tcm_write(idx, word);
+        addr += len;
+        data += len;
+        size -= len;
+    }
+}
+
+static inline void sim_tcm_read(uint32_t addr, uint8_t* data, uint32_t size)
+{
+    sim_tcm_scope();
+    while (size != 0)
+    {
+        uint32_t ofs = addr & 3;
+        uint32_t len = ((4 - ofs) < size) ? (4 - ofs) : size;
+        uint32_t word = tcm_read((addr - TCM_BASE) >> 2);
+        for (uint32_t i=0 ; i<len ; ++i)
+        {
+            data[i] = word >> ((ofs + i) * 8);
+        }
+        addr += len;
+        data += len;
+        size -= len;
+    }
+}
+#endif
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "sim_retire.h"
+
+// File layout, decoded offline by sim/trace_decode.py:
+//   header  "RVTRACE1", u32 record size, u32 reserved
+//   records TraceRecord, little-endian
+#define TRACE_BIN_MAGIC         "RVTRACE1"
+#define TRACE_BIN_RING_SIZE     (1u << 16)
+#define TRACE_BIN_IDLE_US       200
+
+// TraceRecord::type
+#define TRACE_REC_RETIRE        0
+#define TRACE_REC_EVENT         1   // id in pc
+#define TRACE_REC_FINISH        2
+
+// TraceRecord::flags, RETIRE_F_* are shifted above these
+#define TRACE_F_REG_WRITE       (1u << 0)
+#define TRACE_F_MEM_READ        (1u << 1)
+#define TRACE_F_MEM_WRITE       (1u << 2)
+#define TRACE_F_PIPE_SHIFT      8
+
+#pragma pack(push, 1)
+struct TraceRecord
+{
+    uint64_t    time;
+    uint64_t    cycle;
+    uint32_t    pc;
+    uint32_t    instr;
+    uint32_t    rd_old;
+    uint32_t    rd_data;
+    uint32_t    mem_addr;
+    uint32_t    mem_wdata;
+    uint32_t    mem_rdata;
+    uint16_t    flags;
+    uint8_t     mem_sel;
+    uint8_t     type;
+};
+#pragma pack(pop)
+
+// Binary retire trace (+trace_bin=<file>). The simulation thread only copies
+// fixed-size records into a ring buffer, a background thread writes them out,
+// so a traced run doesn't pay for the text formatting of trace.txt.
+class SimTraceBin : public RetireSink
+{
+public:
+    SimTraceBin()
+        : m_file(nullptr)
+        , m_ring(TRACE_BIN_RING_SIZE)
+        , m_head(0)
+        , m_tail(0)
+        , m_stop(false)
+        , m_records(0)
+        , m_last_time(0)
+    {
+    }
+
+    ~SimTraceBin()
+    {
+        finish();
+    }
+
+    bool open(const char* file_name)
+    {
+        m_file = fopen(file_name, "wb");
+        if (m_file == nullptr)
+        {
+            printf("SIM: unable to create binary trace '%s'\n", file_name);
+            return false;
+        }
+        uint32_t header[2] = { (uint32_t)sizeof(TraceRecord), 0 };
+        fwrite(TRACE_BIN_MAGIC, 1, 8, m_file);
+        fwrite(header, sizeof(header), 1, m_file);
+        m_writer = std::thread(&SimTraceBin::writer, this);
+        return true;
+    }
+
+    int on_retire(const RetireInfo& info) override
+    {
+        TraceRecord rec;
+        rec.time = info.time;
+        rec.cycle = info.cycle;
+        rec.pc = info.pc;
+        rec.instr = info.instr;
+        rec.rd_old = info.rd_old;
+        rec.rd_data = info.reg_data;
+        rec.mem_addr = info.mem_addr;
+        rec.mem_wdata = info.mem_wdata;
+        rec.mem_rdata = info.mem_rdata;
+        rec.flags = (uint16_t)((info.reg_write ? TRACE_F_REG_WRITE : 0) |
+                               (info.mem_read ? TRACE_F_MEM_READ : 0) |
+                               (info.mem_write ? TRACE_F_MEM_WRITE : 0) |
+                               (info.flags << TRACE_F_PIPE_SHIFT));
+        rec.mem_sel = (uint8_t)info.mem_sel;
+        rec.type = TRACE_REC_RETIRE;
+        push(rec);
+        return 0;
+    }
+
+    void on_event(uint64_t time, uint32_t id) override
+    {
+        push_marker(TRACE_REC_EVENT, time, id);
+    }
+
+    // end of trace, "Trace finished." of the decoder
+    void finish() override
+    {
+        if (m_file == nullptr)
+        {
+            return;
+        }
+        push_marker(TRACE_REC_FINISH, m_last_time, 0);
+        m_stop.store(true, std::memory_order_release);
+        m_writer.join();
+        fclose(m_file);
+        m_file = nullptr;
+        printf("SIM: binary trace, %llu records\n", (unsigned long long)m_records);
+    }
+
+private:
+    void push_marker(uint8_t type, uint64_t time, uint32_t id)
+    {
+        TraceRecord rec;
+        memset(&rec, 0, sizeof(rec));
+        rec.time = time;
+        rec.pc = id;
+        rec.type = type;
+        push(rec);
+    }
+
+    // single producer (simulation thread), single consumer (writer thread)
+    void push(const TraceRecord& rec)
+    {
+        if (m_file == nullptr)
+        {
+            return;
+        }
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        while ((head - m_tail.load(std::memory_order_acquire)) >= TRACE_BIN_RING_SIZE)
+        {
+            std::this_thread::yield();
+        }
+        m_ring[head & (TRACE_BIN_RING_SIZE - 1)] = rec;
+        m_head.store(head + 1, std::memory_order_release);
+        m_last_time = rec.time;
+        ++m_records;
+    }
+
+    void writer()
+    {
+        while (true)
+        {
+            uint64_t tail = m_tail.load(std::memory_order_relaxed);
+            // stop flag is read before head, so everything pushed before it is drained
+            bool stop = m_stop.load(std::memory_order_acquire);
+            uint64_t head = m_head.load(std::memory_order_acquire);
+            if (head == tail)
+            {
+                if (stop)
+                {
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(TRACE_BIN_IDLE_US));
+                continue;
+            }
+            // up to the end of the ring, the wrapped part goes on the next pass
+            uint64_t first = tail & (TRACE_BIN_RING_SIZE - 1);
+            uint64_t count = std::min<uint64_t>(head - tail, TRACE_BIN_RING_SIZE - first);
+            fwrite(&m_ring[first], sizeof(TraceRecord), count, m_file);
+            m_tail.store(tail + count, std::memory_order_release);
+        }
+    }
+
+    FILE*                       m_file;
+    std::vector<TraceRecord>    m_ring;
+    std::atomic<uint64_t>       m_head;
+    std::atomic<uint64_t>       m_tail;
+    std::atomic<bool>           m_stop;
+    std::thread                 m_writer;
+    uint64_t                    m_records;
+    uint64_t                    m_last_time;
+};
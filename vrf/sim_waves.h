@@ -0,0 +1,268 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include "verilated_fst_c.h"
+#include "tb.h"
+#include "sim_retire.h"
+
+#define WAVES_LEVELS        99
+#define WAVES_SCOPE_PREFIX  "TOP.tb_top."
+#define WAVES_NEVER         ((uint64_t)-1)
+
+// Harness-owned waveform capture of a model built with waves=1. Dumping is
+// limited to a cycle window, optionally armed by a retired PC or a firmware
+// marker, and to selected scopes. With a pre-trigger window the dump rotates
+// between two segment files of that length, so the cycles before the trigger
+// are kept in <name>_pre.fst next to <name>.fst.
+class SimWaves : public RetireSink
+{
+public:
+    enum State
+    {
+        WAVES_WAIT,     // before the start cycle
+        WAVES_ARMED,    // waiting for a trigger, no dump
+        WAVES_PRE,      // waiting for a trigger, dump into rotating segments
+        WAVES_ON,
+        WAVES_DONE
+    };
+
+    SimWaves()
+        : m_fst(nullptr)
+        , m_state(WAVES_WAIT)
+        , m_start(0)
+        , m_stop(WAVES_NEVER)
+        , m_use_pc(false)
+        , m_pc(0)
+        , m_marker(0)
+        , m_pre(0)
+        , m_post(WAVES_NEVER)
+        , m_seg(0)
+        , m_seg_start(0)
+        , m_seg_prev(false)
+        , m_segmented(false)
+    {
+    }
+
+    ~SimWaves()
+    {
+        finish();
+    }
+
+    // scopes are comma separated, relative to tb_top (e.g. "u_rv.u_core"), all by default
+    void init(TOP_CLASS* top, VerilatedContext* ctx, const char* file_name, const char* scopes)
+    {
+        m_file = file_name;
+        size_t ext = m_file.rfind(".fst");
+        m_base = (ext == std::string::npos) ? m_file : m_file.substr(0, ext);
+        ctx->traceEverOn(true);
+        m_fst = new VerilatedFstC;
+        if (scopes != nullptr)
+        {
+            add_scopes(scopes);
+        }
+        top->trace(m_fst, WAVES_LEVELS);
+    }
+
+    void set_window(uint64_t start, uint64_t stop)
+    {
+        m_start = start;
+        m_stop = stop;
+    }
+
+    void set_pc_trigger(uint32_t pc)
+    {
+        m_use_pc = true;
+        m_pc = pc;
+    }
+
+    void set_marker_trigger(uint32_t marker) { m_marker = marker; }
+
+    // cycles kept before the trigger and dumped after it
+    void set_pre(uint64_t cycles) { m_pre = cycles; }
+    void set_post(uint64_t cycles) { m_post = cycles; }
+
+    bool use_retire() const { return m_use_pc; }
+
+    // after every evaluation of the model
+    void dump(uint64_t time)
+    {
+        if ((m_state == WAVES_PRE) || (m_state == WAVES_ON))
+        {
+            m_fst->dump(time);
+        }
+    }
+
+    // after every rising edge
+    void on_cycle(uint64_t cycle)
+    {
+        switch (m_state)
+        {
+        case WAVES_WAIT:
+            if (cycle < m_start)
+            {
+                break;
+            }
+            if (!has_trigger())
+            {
+                open_file(m_file);
+                m_state = WAVES_ON;
+                printf("SIM: waves started at cycle %ld\n", cycle);
+            }
+            else if (m_pre != 0)
+            {
+                open_segment(cycle);
+                m_state = WAVES_PRE;
+            }
+            else
+            {
+                m_state = WAVES_ARMED;
+            }
+            break;
+        case WAVES_PRE:
+            if ((cycle - m_seg_start) >= m_pre)
+            {
+                m_fst->close();
+                m_seg ^= 1;
+                m_seg_prev = true;
+                open_segment(cycle);
+            }
+            break;
+        case WAVES_ON:
+            if (cycle >= m_stop)
+            {
+                close();
+                printf("SIM: waves stopped at cycle %ld\n", cycle);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    void on_marker(uint64_t cycle, uint32_t marker)
+    {
+        if (marker == m_marker)
+        {
+            trigger(cycle);
+        }
+    }
+
+    int on_retire(const RetireInfo& info) override
+    {
+        if (m_use_pc && (info.pc == m_pc))
+        {
+            trigger(info.cycle);
+        }
+        return 0;
+    }
+
+    void finish() override
+    {
+        close();
+    }
+
+private:
+    bool has_trigger() const { return m_use_pc || (m_marker != 0); }
+
+    void add_scopes(const char* scopes)
+    {
+        std::string list(scopes);
+        size_t pos = 0;
+        while (pos <= list.size())
+        {
+            size_t end = list.find(',', pos);
+            if (end == std::string::npos)
+            {
+                end = list.size();
+            }
+            std::string scope = list.substr(pos, end - pos);
+            if (!scope.empty())
+            {
+                if (scope.compare(0, 4, "TOP.") != 0)
+                {
+                    scope = WAVES_SCOPE_PREFIX + scope;
+                }
+#if VERILATOR_VERSION_INTEGER >= 5000000
+                m_fst->dumpvars(WAVES_LEVELS, scope);
+#else
+                printf("SIM: +waves_scope needs Verilator 5, '%s' ignored\n", scope.c_str());
+#endif
+            }
+            pos = end + 1;
+        }
+    }
+
+    std::string segment_name(int seg) const
+    {
+        return m_base + "_seg" + std::to_string(seg) + ".fst";
+    }
+
+    void open_file(const std::string& name)
+    {
+        m_fst->open(name.c_str());
+    }
+
+    void open_segment(uint64_t cycle)
+    {
+        open_file(segment_name(m_seg));
+        m_seg_start = cycle;
+        m_segmented = true;
+    }
+
+    void trigger(uint64_t cycle)
+    {
+        if (m_state == WAVES_ARMED)
+        {
+            open_file(m_file);
+        }
+        else if (m_state != WAVES_PRE)
+        {
+            return;
+        }
+        m_state = WAVES_ON;
+        if (m_post != WAVES_NEVER)
+        {
+            m_stop = std::min(m_stop, cycle + m_post);
+        }
+        printf("SIM: waves triggered at cycle %ld\n", cycle);
+    }
+
+    // segments get their final names once closed
+    void close()
+    {
+        if ((m_state != WAVES_PRE) && (m_state != WAVES_ON))
+        {
+            m_state = WAVES_DONE;
+            return;
+        }
+        m_fst->close();
+        if (m_segmented)
+        {
+            std::rename(segment_name(m_seg).c_str(), m_file.c_str());
+            if (m_seg_prev)
+            {
+                std::rename(segment_name(m_seg ^ 1).c_str(), (m_base + "_pre.fst").c_str());
+            }
+        }
+        m_state = WAVES_DONE;
+    }
+
+    VerilatedFstC*  m_fst;
+    State           m_state;
+    std::string     m_file;
+    std::string     m_base;
+    uint64_t        m_start;
+    uint64_t        m_stop;
+    bool            m_use_pc;
+    uint32_t        m_pc;
+    uint32_t        m_marker;
+    uint64_t        m_pre;
+    uint64_t        m_post;
+    int             m_seg;
+    uint64_t        m_seg_start;
+    bool            m_seg_prev;
+    bool            m_segmented;
+};
@@ -1,19 +1,40 @@
 #include <memory>
 #include <chrono>
-#include <ctime> 
+#include <ctime>
 #include <cstdlib>
+#include <thread>
+#include <vector>
 #include "tb.h"
+#include "sim_args.h"
+#include "math_check.h"
 
 double sc_time_stamp() { return 0; }
 
 #define TICK_TIME 2
 #define TICK_PERIOD (TICK_TIME / 2)
-#define SIM_TIME_MAX (1000*10)
-#define SIM_TIME_MAX_TICK (TICK_TIME * SIM_TIME_MAX)
 
-#define ROUNDS (10*1000)
+// operations per class and lane, "+ops=N"
+#define OPS_DEFAULT (1000*1000)
+// a multiplication which doesn't finish in that many cycles is a failure
+#define MUL_CYCLES_MAX 1000
 
-int64_t time_max;
+// Classes of mint (rtl/core/math/mint.sv), all of them over the full operand range.
+// The multiplier is exact for unsigned operands below 2^31 only and signed/signed
+// division gives the remainder the sign of the quotient: these are known failures,
+// "+strict" fails the run on them. The *31 classes keep the domain the multiplier
+// handles, so a regression there isn't hidden by the known failures.
+static const MathClass math_classes[] = {
+    {"mul_uu",   MATH_MUL, false, false, 32, 32, "unsigned operands of 2^31 and above"},
+    {"mul_su",   MATH_MUL, true,  false, 32, 32, "unsigned op2 of 2^31 and above"},
+    {"mul_ss",   MATH_MUL, true,  true,  32, 32, nullptr},
+    {"mul_uu31", MATH_MUL, false, false, 31, 31, nullptr},
+    {"mul_su31", MATH_MUL, true,  false, 32, 31, nullptr},
+    {"div_uu",   MATH_DIV, false, false, 32, 32, nullptr},
+    {"div_su",   MATH_DIV, true,  false, 32, 32, nullptr},
+    {"div_ss",   MATH_DIV, true,  true,  32, 32, "remainder takes the sign of the quotient"},
+};
+#define MATH_CLASSES (sizeof(math_classes) / sizeof(math_classes[0]))
+#define MATH_CLASSES_DEFAULT "mul_uu,mul_su,mul_ss,mul_uu31,mul_su31,div_uu,div_su,div_ss"
 
 int on_step_cb(uint64_t time, TOP_CLASS* p_top)
 {
@@ -24,204 +45,240 @@ int on_step_cb(uint64_t time, TOP_CLASS* p_top)
     return 0;
 }
 
-bool check_div_rem(TB* tb)
+// One model instance driven by its own thread, the model and the context
+// aren't shared with other lanes.
+class MathLane
 {
-    uint64_t op1, op2, div, rem, div_check, rem_check;
-    TOP_CLASS* top = tb->get_top();
-    top->i_op1_signed = 0;
-    top->i_op2_signed = 0;
-    printf("div/rem - unsigned/unsigned.\n");
-    for (uint64_t round=0 ; round<=ROUNDS ; ++round)
+public:
+    MathLane(uint32_t id, VerilatedContext* ctx, TOP_CLASS* top)
+        : m_id(id)
+        , m_ctx(ctx)
+        , m_top(top)
+        , m_cycle(0)
     {
-        op1 = std::rand();
-        op2 = std::rand();
-        top->i_op1 = op1;
-        top->i_op2 = op2;
-        tb->run_steps(2);
-        if (op2 == 0)
-        {
-            div_check = 0;
-            rem_check = 0;
-        }
-        else
-        {
-            div_check = op1 / op2;
-            rem_check = op1 % op2;
-        }
-        div = top->o_div;
-        rem = top->o_rem;
-        if ((div != div_check) || (rem != rem_check))
-        {
-            printf("[%d] Check failed! %ld/%ld=%ld(%ld), expected %ld(%ld)\n",
-                round, op1, op2, div, rem, div_check, rem_check);
-            return false;
-        }
     }
-    int64_t op1s, divs, rems, divs_check, rems_check;
-    top->i_op1_signed = 1;
-    top->i_op2_signed = 0;
-    printf("div/rem - signed/unsigned.\n");
-    for (uint64_t round=0 ; round<=ROUNDS ; ++round)
+
+    void reset()
     {
-        op1s = (1 - std::rand());
-        op2 = std::rand();
-        top->i_op1 = op1s;
-        top->i_op2 = op2;
-        tb->run_steps(2);
-        if (op2 == 0)
-        {
-            divs_check = 0;
-            rems_check = 0;
-        }
-        else
-        {
-            divs_check = op1s / op2;
-            rems_check = op1s % op2;
-        }
-        divs = top->o_div;
-        rems = top->o_rem;
-        if ((divs != divs_check) || (rems != rems_check))
+        m_top->i_clk = 0;
+        m_top->i_reset_n = 0;
+        m_top->i_start = 0;
+        m_top->i_op1 = 0;
+        m_top->i_op2 = 0;
+        m_top->i_op1_signed = 0;
+        m_top->i_op2_signed = 0;
+        tick();
+        tick();
+        m_top->i_reset_n = 1;
+    }
+
+    void run(const std::vector<uint32_t>& sel, uint64_t ops, uint64_t seed)
+    {
+        m_stats.resize(MATH_CLASSES);
+        for (uint32_t idx : sel)
         {
-            printf("[%d] Check failed! %ld/%ld=%ld(%ld), expected %ld(%ld)\n",
-                round, op1s, op2, divs, rems, divs_check, rems_check);
-            return false;
+            const MathClass& cls = math_classes[idx];
+            MathStim stim(seed, m_id, idx);
+            auto start = std::chrono::steady_clock::now();
+            if (cls.op == MATH_MUL)
+            {
+                run_mul(cls, stim, ops, m_stats[idx]);
+            }
+            else
+            {
+                run_div(cls, stim, ops, m_stats[idx]);
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            m_stats[idx].seconds = elapsed.count();
         }
     }
-    return true;
-}
 
-bool check_mul(TB* tb)
-{
-    uint64_t op1, op2, mul, mul_check;
-    int64_t op1s, op2s, muls, muls_check;
-    TOP_CLASS* top = tb->get_top();
+    const std::vector<MathStats>& get_stats() const { return m_stats; }
 
-    //return false;
+private:
+    void tick()
+    {
+        m_top->i_clk = 1;
+        m_top->eval();
+        m_ctx->timeInc(TICK_PERIOD);
+        m_top->i_clk = 0;
+        m_top->eval();
+        m_ctx->timeInc(TICK_PERIOD);
+        ++m_cycle;
+    }
 
-    top->i_op1_signed = 0;
-    top->i_op2_signed = 0;
-    printf("mul - unsigned/unsigned.\n");
-    for (uint64_t round=0 ; round<=ROUNDS ; ++round)
+    void check(const MathClass& cls, MathStats& s, uint64_t idx, uint32_t op1, uint32_t op2,
+               const MathResult& res)
     {
-        op1 = std::rand();
-        op2 = std::rand();
-        top->i_op1 = op1;
-        top->i_op2 = op2;
-        top->i_start = 1;
-        tb->run_steps(TICK_TIME);
-        top->i_start = 0;
-        tb->run_steps(TICK_TIME * 32);
-        if (op2 == 0)
-        {
-            mul_check = 0;
-        }
-        else
+        MathResult exp = math_ref(cls, op1, op2);
+        ++s.ops;
+        if (!math_equal(cls, res, exp))
         {
-            mul_check = op1 * op2;
-        }
-        mul = top->o_mul;
-        if (mul != mul_check)
-        {
-            printf("[%d] Check failed! %ld*%ld=0x%016lx, expected 0x%016lx\n",
-                round, op1, op2, mul, mul_check);
-            return false;
+            ++s.fails;
+            if (s.fail_list.size() < MATH_FAILS_MAX)
+            {
+                s.fail_list.push_back({m_id, idx, op1, op2, res, exp});
+            }
         }
     }
-    top->i_op1_signed = 1;
-    top->i_op2_signed = 0;
-    printf("mul - signed/unsigned.\n");
-    for (uint64_t round=0 ; round<=ROUNDS ; ++round)
+
+    // Back-to-back: the clock edge which completes an operation issues the next one.
+    void run_mul(const MathClass& cls, MathStim& stim, uint64_t ops, MathStats& s)
     {
-        op1s = (1 - std::rand());
-        op2 = std::rand();
-        top->i_op1 = op1s;
-        top->i_op2 = op2;
-        top->i_start = 1;
-        tb->run_steps(TICK_TIME);
-        top->i_start = 0;
-        tb->run_steps(TICK_TIME * 32);
-        if (op2 == 0)
+        uint32_t op1, op2, next1 = 0, next2 = 0;
+        m_top->i_start = 0;
+        m_top->i_op1_signed = cls.op1_signed;
+        m_top->i_op2_signed = cls.op2_signed;
+        tick();
+        stim.next(cls, op1, op2);
+        m_top->i_op1 = op1;
+        m_top->i_op2 = op2;
+        m_top->i_start = 1;
+        uint64_t first = m_cycle;
+        uint64_t issued = m_cycle;
+        tick();
+        for (uint64_t i=0 ; i<ops ; ++i)
         {
-            muls_check = 0;
-        }
-        else
-        {
-            muls_check = op1s * op2;
-        }
-        muls = top->o_mul;
-        if (muls != muls_check)
-        {
-            printf("[%d] Check failed! %ld*%ld=0x%016x, expected 0x%016x\n",
-                round, op1s, op2, muls, muls_check);
-            return false;
+            m_top->i_start = 0;
+            while (!m_top->o_mul_ready)
+            {
+                if ((m_cycle - issued) > MUL_CYCLES_MAX)
+                {
+                    printf("[lane %u] %s #%lu isn't finished in %d cycles\n",
+                           m_id, cls.name, i, MUL_CYCLES_MAX);
+                    ++s.fails;
+                    return;
+                }
+                tick();
+            }
+            if ((i + 1) < ops)
+            {
+                stim.next(cls, next1, next2);
+                m_top->i_op1 = next1;
+                m_top->i_op2 = next2;
+                m_top->i_start = 1;
+            }
+            tick();
+            s.latency(m_cycle - issued);
+            s.cycles = m_cycle - first;
+            MathResult res = {(uint64_t)m_top->o_mul, 0, 0};
+            check(cls, s, i, op1, op2, res);
+            op1 = next1;
+            op2 = next2;
+            issued = m_cycle - 1;
         }
+        m_top->i_start = 0;
     }
-    top->i_op1_signed = 1;
-    top->i_op2_signed = 1;
-    printf("mul - signed/signed.\n");
-    for (uint64_t round=0 ; round<=ROUNDS ; ++round)
+
+    // Division is combinational, one operation per cycle and zero latency.
+    void run_div(const MathClass& cls, MathStim& stim, uint64_t ops, MathStats& s)
     {
-        op1s = (1 - std::rand());
-        op2s = (1 - std::rand());
-        top->i_op1 = op1s;
-        top->i_op2 = op2s;
-        top->i_start = 1;
-        tb->run_steps(TICK_TIME);
-        top->i_start = 0;
-        tb->run_steps(TICK_TIME * 32);
-        if (op2s == 0)
-        {
-            muls_check = 0;
-        }
-        else
-        {
-            muls_check = op1s * op2s;
-        }
-        muls = top->o_mul;
-        if (muls != muls_check)
+        uint32_t op1, op2;
+        m_top->i_start = 0;
+        m_top->i_op1_signed = cls.op1_signed;
+        m_top->i_op2_signed = cls.op2_signed;
+        for (uint64_t i=0 ; i<ops ; ++i)
         {
-            printf("[%d] Check failed! %ld*%ld=0x%016x, expected 0x%016x\n",
-                round, op1s, op2s, muls, muls_check);
-            return false;
+            stim.next(cls, op1, op2);
+            m_top->i_op1 = op1;
+            m_top->i_op2 = op2;
+            tick();
+            MathResult res = {0, (uint32_t)m_top->o_div, (uint32_t)m_top->o_rem};
+            check(cls, s, i, op1, op2, res);
+            s.latency(0);
         }
+        s.cycles += ops;
     }
-    return true;
-}
+
+    uint32_t                m_id;
+    VerilatedContext*       m_ctx;
+    TOP_CLASS*              m_top;
+    uint64_t                m_cycle;
+    std::vector<MathStats>  m_stats;
+};
 
 int main(int argc, char** argv, char** env)
 {
     TB* tb = new TB(TOP_NAME_STR, argc, argv);
     tb->init(on_step_cb);
     TOP_CLASS* top = tb->get_top();
+    VerilatedContext* ctx = tb->get_context();
 
-    top->i_clk = 1;
-    top->i_reset_n = 0;
-    top->i_start = 0;
-    tb->run_steps(TICK_TIME * 2);
-    top->i_reset_n = 1;
+    // +seed=N, +lanes=N (host threads by default), +ops=N per class and lane, +classes=name,...,
+    // +strict - known failures fail the run as well
+    bool strict = plusarg_flag(ctx, "strict");
+    uint64_t seed = plusarg_u64(ctx, "seed", 1);
+    uint32_t lanes = plusarg_u64(ctx, "lanes", std::thread::hardware_concurrency());
+    uint64_t ops = plusarg_u64(ctx, "ops", OPS_DEFAULT);
+    std::vector<uint32_t> sel = math_select(math_classes, MATH_CLASSES,
+                                            plusarg_str(ctx, "classes"), MATH_CLASSES_DEFAULT);
+    lanes = (lanes == 0) ? 1 : lanes;
+    printf("Seed %lu, %u lanes, %lu operations per class and lane.\n", seed, lanes, ops);
 
-    const char* cycles_str = tb->get_context()->commandArgsPlusMatch("cycles");
-    time_max = -1;
-    if (strlen(cycles_str) > 8)
+    // lane 0 drives the model of the TB, the others own a model and a context each
+    std::vector<std::unique_ptr<VerilatedContext>> contexts;
+    std::vector<std::unique_ptr<TOP_CLASS>> models;
+    std::vector<std::unique_ptr<MathLane>> lane_list;
+    lane_list.emplace_back(new MathLane(0, ctx, top));
+    for (uint32_t i=1 ; i<lanes ; ++i)
     {
-        cycles_str += 8;
-        time_max = atoi(cycles_str);
+        contexts.emplace_back(new VerilatedContext);
+        contexts.back()->commandArgs(argc, argv);
+        models.emplace_back(new TOP_CLASS(contexts.back().get(), TOP_NAME_STR));
+        lane_list.emplace_back(new MathLane(i, contexts.back().get(), models.back().get()));
     }
+
     auto start = std::chrono::system_clock::now();
-    int ret = -1;
-    if (check_mul(tb) && check_div_rem(tb))
+    std::vector<std::thread> threads;
+    for (auto& lane : lane_list)
     {
-        ret = 0;
+        MathLane* p = lane.get();
+        threads.emplace_back([p, &sel, ops, seed]() {
+            p->reset();
+            p->run(sel, ops, seed);
+        });
+    }
+    for (auto& t : threads)
+    {
+        t.join();
     }
     auto end = std::chrono::system_clock::now();
     std::chrono::duration<double> elapsed_seconds = end-start;
 
-    printf("Simulation time: %.3f(s)\n", elapsed_seconds);
+    uint64_t fails = 0;
+    uint64_t known = 0;
+    uint64_t total = 0;
+    math_report_head();
+    for (uint32_t idx : sel)
+    {
+        MathStats s;
+        for (auto& lane : lane_list)
+        {
+            s.merge(lane->get_stats()[idx]);
+        }
+        math_report(math_classes[idx], s);
+        if ((math_classes[idx].known != nullptr) && !strict)
+        {
+            known += s.fails;
+        }
+        else
+        {
+            fails += s.fails;
+        }
+        total += s.ops;
+    }
+    printf("%lu operations, %lu failed, %lu known failures, %.2f Mops/s.\n", total, fails, known,
+           total / elapsed_seconds.count() / 1e6);
+    printf("Simulation time: %.3f(s)\n", elapsed_seconds.count());
 
+    for (auto& model : models)
+    {
+        model->final();
+    }
     tb->finish();
     top->final();
 #if VM_COVERAGE
     //tb->get_context()->coveragep()->write(COV_FN);
 #endif
-    return 0;//ret;
+    return (fails == 0) ? 0 : -1;
 }
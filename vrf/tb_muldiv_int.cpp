@@ -0,0 +1,258 @@
+#include <memory>
+#include <chrono>
+#include <ctime>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "tb.h"
+#include "sim_args.h"
+#include "math_check.h"
+
+double sc_time_stamp() { return 0; }
+
+#define TICK_TIME 2
+#define TICK_PERIOD (TICK_TIME / 2)
+
+// operations per class and lane, "+ops=N"
+#define OPS_DEFAULT (1000*1000)
+// an operation which doesn't finish in that many cycles is a failure
+#define MULDIV_CYCLES_MAX 100
+
+// Classes of muldiv (rtl/core/math/muldiv.sv) as rv_alu2 drives it, over the full
+// operand range. A multiplication is the M instruction of its operand signs, the
+// 64-bit product is checked (mul takes the low half, mulh* the high one). Division
+// issues the quotient instruction, then the remainder one back-to-back.
+struct MulDivClass
+{
+    MathClass   cls;
+    uint32_t    funct3;
+};
+
+static const MulDivClass muldiv_classes[] = {
+    {{"mul_ss", MATH_MUL,    true,  true,  32, 32, nullptr}, 1},    // mulh
+    {{"mul_su", MATH_MUL,    true,  false, 32, 32, nullptr}, 2},    // mulhsu
+    {{"mul_uu", MATH_MUL,    false, false, 32, 32, nullptr}, 3},    // mulhu
+    {{"div_ss", MATH_DIV_RV, true,  true,  32, 32, nullptr}, 4},    // div, rem
+    {{"div_uu", MATH_DIV_RV, false, false, 32, 32, nullptr}, 5},    // divu, remu
+};
+#define MULDIV_CLASSES (sizeof(muldiv_classes) / sizeof(muldiv_classes[0]))
+#define MULDIV_CLASSES_DEFAULT "mul_ss,mul_su,mul_uu,div_ss,div_uu"
+
+int on_step_cb(uint64_t time, TOP_CLASS* p_top)
+{
+    if ((time % TICK_PERIOD) == 0)
+    {
+        p_top->i_clk = !p_top->i_clk;
+    }
+    return 0;
+}
+
+// One model instance driven by its own thread, the model and the context
+// aren't shared with other lanes.
+class MulDivLane
+{
+public:
+    MulDivLane(uint32_t id, VerilatedContext* ctx, TOP_CLASS* top)
+        : m_id(id)
+        , m_ctx(ctx)
+        , m_top(top)
+        , m_cycle(0)
+    {
+    }
+
+    void reset()
+    {
+        m_top->i_clk = 0;
+        m_top->i_reset_n = 0;
+        m_top->i_start = 0;
+        m_top->i_funct3 = 0;
+        m_top->i_op1 = 0;
+        m_top->i_op2 = 0;
+        tick();
+        tick();
+        m_top->i_reset_n = 1;
+    }
+
+    void run(const std::vector<uint32_t>& sel, uint64_t ops, uint64_t seed)
+    {
+        m_stats.resize(MULDIV_CLASSES);
+        for (uint32_t idx : sel)
+        {
+            const MulDivClass& md = muldiv_classes[idx];
+            MathStim stim(seed, m_id, idx);
+            MathStats& s = m_stats[idx];
+            auto start = std::chrono::steady_clock::now();
+            uint64_t first = m_cycle;
+            for (uint64_t i=0 ; i<ops ; ++i)
+            {
+                uint32_t op1, op2;
+                stim.next(md.cls, op1, op2);
+                MathResult res = {0, 0, 0};
+                if (!exec(md, s, i, md.funct3, op1, op2, res))
+                {
+                    break;
+                }
+                // the remainder instruction of the pair
+                if ((md.cls.op != MATH_MUL) && !exec(md, s, i, md.funct3 | 2, op1, op2, res))
+                {
+                    break;
+                }
+                check(md.cls, s, i, op1, op2, res);
+            }
+            s.cycles = m_cycle - first;
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            s.seconds = elapsed.count();
+        }
+    }
+
+    const std::vector<MathStats>& get_stats() const { return m_stats; }
+
+private:
+    void tick()
+    {
+        m_top->i_clk = 1;
+        m_top->eval();
+        m_ctx->timeInc(TICK_PERIOD);
+        m_top->i_clk = 0;
+        m_top->eval();
+        m_ctx->timeInc(TICK_PERIOD);
+        ++m_cycle;
+    }
+
+    // Issues in the cycle the previous result is read, so operations go back-to-back.
+    bool exec(const MulDivClass& md, MathStats& s, uint64_t idx, uint32_t funct3,
+              uint32_t op1, uint32_t op2, MathResult& res)
+    {
+        m_top->i_start = 1;
+        m_top->i_funct3 = funct3;
+        m_top->i_op1 = op1;
+        m_top->i_op2 = op2;
+        uint64_t issued = m_cycle;
+        tick();
+        m_top->i_start = 0;
+        while (!m_top->o_ready)
+        {
+            if ((m_cycle - issued) > MULDIV_CYCLES_MAX)
+            {
+                printf("[lane %u] %s #%lu (funct3 %u) isn't finished in %d cycles\n",
+                       m_id, md.cls.name, idx, funct3, MULDIV_CYCLES_MAX);
+                ++s.fails;
+                return false;
+            }
+            tick();
+        }
+        s.latency(m_cycle - issued);
+        if (md.cls.op == MATH_MUL)
+        {
+            res.mul = (uint64_t)m_top->o_mul;
+        }
+        else if (funct3 & 2)
+        {
+            res.rem = (uint32_t)m_top->o_rem;
+        }
+        else
+        {
+            res.div = (uint32_t)m_top->o_div;
+        }
+        return true;
+    }
+
+    void check(const MathClass& cls, MathStats& s, uint64_t idx, uint32_t op1, uint32_t op2,
+               const MathResult& res)
+    {
+        MathResult exp = math_ref(cls, op1, op2);
+        ++s.ops;
+        if (!math_equal(cls, res, exp))
+        {
+            ++s.fails;
+            if (s.fail_list.size() < MATH_FAILS_MAX)
+            {
+                s.fail_list.push_back({m_id, idx, op1, op2, res, exp});
+            }
+        }
+    }
+
+    uint32_t                m_id;
+    VerilatedContext*       m_ctx;
+    TOP_CLASS*              m_top;
+    uint64_t                m_cycle;
+    std::vector<MathStats>  m_stats;
+};
+
+int main(int argc, char** argv, char** env)
+{
+    TB* tb = new TB(TOP_NAME_STR, argc, argv);
+    tb->init(on_step_cb);
+    TOP_CLASS* top = tb->get_top();
+    VerilatedContext* ctx = tb->get_context();
+
+    // +seed=N, +lanes=N (host threads by default), +ops=N per class and lane, +classes=name,...
+    uint64_t seed = plusarg_u64(ctx, "seed", 1);
+    uint32_t lanes = plusarg_u64(ctx, "lanes", std::thread::hardware_concurrency());
+    uint64_t ops = plusarg_u64(ctx, "ops", OPS_DEFAULT);
+    std::vector<MathClass> classes;
+    for (const MulDivClass& md : muldiv_classes)
+    {
+        classes.push_back(md.cls);
+    }
+    std::vector<uint32_t> sel = math_select(classes.data(), MULDIV_CLASSES,
+                                            plusarg_str(ctx, "classes"), MULDIV_CLASSES_DEFAULT);
+    lanes = (lanes == 0) ? 1 : lanes;
+    printf("Seed %lu, %u lanes, %lu operations per class and lane.\n", seed, lanes, ops);
+
+    // lane 0 drives the model of the TB, the others own a model and a context each
+    std::vector<std::unique_ptr<VerilatedContext>> contexts;
+    std::vector<std::unique_ptr<TOP_CLASS>> models;
+    std::vector<std::unique_ptr<MulDivLane>> lane_list;
+    lane_list.emplace_back(new MulDivLane(0, ctx, top));
+    for (uint32_t i=1 ; i<lanes ; ++i)
+    {
+        contexts.emplace_back(new VerilatedContext);
+        contexts.back()->commandArgs(argc, argv);
+        models.emplace_back(new TOP_CLASS(contexts.back().get(), TOP_NAME_STR));
+        lane_list.emplace_back(new MulDivLane(i, contexts.back().get(), models.back().get()));
+    }
+
+    auto start = std::chrono::system_clock::now();
+    std::vector<std::thread> threads;
+    for (auto& lane : lane_list)
+    {
+        MulDivLane* p = lane.get();
+        threads.emplace_back([p, &sel, ops, seed]() {
+            p->reset();
+            p->run(sel, ops, seed);
+        });
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+    auto end = std::chrono::system_clock::now();
+    std::chrono::duration<double> elapsed_seconds = end-start;
+
+    uint64_t fails = 0;
+    uint64_t total = 0;
+    math_report_head();
+    for (uint32_t idx : sel)
+    {
+        MathStats s;
+        for (auto& lane : lane_list)
+        {
+            s.merge(lane->get_stats()[idx]);
+        }
+        math_report(classes[idx], s);
+        fails += s.fails;
+        total += s.ops;
+    }
+    printf("%lu operations, %lu failed, %.2f Mops/s.\n", total, fails,
+           total / elapsed_seconds.count() / 1e6);
+    printf("Simulation time: %.3f(s)\n", elapsed_seconds.count());
+
+    for (auto& model : models)
+    {
+        model->final();
+    }
+    tb->finish();
+    top->final();
+    return (fails == 0) ? 0 : -1;
+}
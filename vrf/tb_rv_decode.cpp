@@ -0,0 +1,322 @@
+#include <memory>
+#include <chrono>
+#include <ctime>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "tb.h"
+#include "sim_args.h"
+#include "rv_decode_ref.h"
+
+double sc_time_stamp() { return 0; }
+
+// opcode[6:2] x funct3 x funct7, opcode[1:0] is 2'b11
+#define COMBOS          (32 * 8 * 128)
+// register fields and immediates per combination, "+samples=N"
+#define SAMPLES_DEFAULT 256
+// log lines kept per class and lane
+#define LOG_MAX         4096
+#define LOG_DEFAULT     TOP_NAME_STR ".csv"
+
+// Every encoding is checked against rv_decode_ref() (vrf/rv_decode_ref.h):
+//  mismatch    - canonical encoding, an output differs
+//  flagged     - canonical encoding reported as unsupported
+//  unflagged   - non-canonical or reserved encoding (e.g. slli with imm[11:5]
+//                set, lw with funct3 3) reported as supported; a failure with +strict
+enum DecodeClass
+{
+    DECODE_OK,
+    DECODE_MISMATCH,
+    DECODE_FLAGGED,
+    DECODE_UNFLAGGED,
+    DECODE_CLASSES
+};
+
+static const char* const decode_class_names[DECODE_CLASSES] = {
+    "ok", "mismatch", "flagged", "unflagged"
+};
+
+struct DecodeLog
+{
+    uint32_t    instr;
+    uint32_t    cls;
+    uint32_t    row;
+    uint32_t    diff;
+    uint32_t    ctrl;
+    uint32_t    ctrl_exp;
+};
+
+int on_step_cb(uint64_t time, TOP_CLASS* p_top)
+{
+    return 0;
+}
+
+static RvDecodeOut decode_read(TOP_CLASS* top)
+{
+    RvDecodeOut out;
+    out.supported = top->o_inst_supported;
+    out.ctrl =
+        ((top->o_reg_write && (top->o_rd != 0)) ? DEC_REG_WRITE : 0) |
+        (top->o_res_memory ? DEC_RES_MEM : 0) |
+        (top->o_res_pc_next ? DEC_RES_PC_NEXT : 0) |
+        (top->o_res_alu ? DEC_RES_ALU : 0) |
+        (top->o_op1_src ? DEC_OP1_PC : 0) |
+        (top->o_op2_src ? DEC_OP2_IMM : 0) |
+        (top->o_inst_jal ? DEC_JAL : 0) |
+        (top->o_inst_jalr ? DEC_JALR : 0) |
+        (top->o_inst_branch ? DEC_BRANCH : 0) |
+        (top->o_inst_store ? DEC_STORE : 0) |
+        (top->o_inst_mret ? DEC_MRET : 0) |
+        (top->o_csr_write ? DEC_CSR_WRITE : 0) |
+        (top->o_csr_set ? DEC_CSR_SET : 0) |
+        (top->o_csr_clear ? DEC_CSR_CLEAR : 0) |
+        (top->o_csr_read ? DEC_CSR_READ : 0) |
+        (top->o_csr_ebreak ? DEC_CSR_EBREAK : 0) |
+        (top->o_alu_add_override ? DEC_ADD : 0) |
+        (top->o_alu_op2_inverse ? DEC_OP2_INV : 0) |
+        (top->o_alu_sh_ar ? DEC_SH_AR : 0) |
+        (top->o_alu_group_mux ? DEC_GROUP_MUX : 0) |
+        (top->o_alu_div_mux ? DEC_DIV_MUX : 0);
+    out.imm = top->o_imm_i;
+    out.rd = top->o_rd;
+    out.rs1 = top->o_rs1;
+    out.rs2 = top->o_rs2;
+    out.funct3 = top->o_funct3;
+    out.csr_idx = top->o_csr_idx;
+    out.csr_imm = top->o_csr_imm;
+    return out;
+}
+
+// One model instance driven by its own thread, it takes every 'lanes'-th combination.
+class DecodeLane
+{
+public:
+    DecodeLane(uint32_t id, TOP_CLASS* top)
+        : m_id(id)
+        , m_top(top)
+        , m_counts()
+        , m_logged()
+        , m_hits(RV_DECODE_ROWS)
+    {
+    }
+
+    void run(uint32_t lanes, uint32_t samples, uint64_t seed)
+    {
+        std::seed_seq seq = {(uint32_t)seed, (uint32_t)(seed >> 32), m_id};
+        std::mt19937 rng(seq);
+        for (uint32_t combo=m_id ; combo<COMBOS ; combo+=lanes)
+        {
+            uint32_t base = ((combo >> 8) << 25) | (((combo >> 5) & 7) << 12) |
+                            ((combo & 0x1f) << 2) | 3;
+            for (uint32_t s=0 ; s<samples ; ++s)
+            {
+                check(base | fields(rng, s), rng());
+            }
+        }
+    }
+
+    uint64_t get_count(int cls) const { return m_counts[cls]; }
+    uint64_t get_hits(uint32_t row) const { return m_hits[row]; }
+    const std::vector<DecodeLog>& get_log() const { return m_log; }
+
+private:
+    // rd, rs1 and rs2; the first samples keep them zero, rs2 1 and 2 for
+    // the system encodings, the others are zero or small with some probability.
+    static uint32_t reg_field(std::mt19937& rng)
+    {
+        uint32_t r = rng();
+        return ((r & 3) == 0) ? 0 : ((r & 7) == 1) ? ((r >> 3) & 3) : ((r >> 8) & 0x1f);
+    }
+
+    static uint32_t fields(std::mt19937& rng, uint32_t sample)
+    {
+        if (sample < 3)
+        {
+            return sample << 20;
+        }
+        return (reg_field(rng) << 20) | (reg_field(rng) << 15) | (reg_field(rng) << 7);
+    }
+
+    void check(uint32_t instr, uint32_t pc)
+    {
+        uint32_t pc_next = pc + 4;
+        m_top->i_instruction = instr;
+        m_top->i_pc = pc >> 1;
+        m_top->i_pc_next = pc_next >> 1;
+        m_top->eval();
+
+        const RvDecodeRow* row = rv_decode_lookup(instr);
+        RvDecodeOut res = decode_read(m_top);
+        RvDecodeOut exp = rv_decode_ref(instr, row);
+        uint32_t diff = rv_decode_compare(row, res, exp);
+        if ((m_top->o_pc != (pc >> 1)) || (m_top->o_pc_next != (pc_next >> 1)))
+        {
+            diff |= DEC_DIFF_PC;
+        }
+
+        DecodeClass cls = DECODE_OK;
+        if (row != nullptr)
+        {
+            ++m_hits[row - rv_decode_table];
+            cls = !res.supported ? DECODE_FLAGGED : (diff != 0) ? DECODE_MISMATCH : DECODE_OK;
+        }
+        else if (res.supported)
+        {
+            cls = DECODE_UNFLAGGED;
+        }
+        ++m_counts[cls];
+        if ((cls != DECODE_OK) && (m_logged[cls] < LOG_MAX))
+        {
+            ++m_logged[cls];
+            uint32_t idx = (row != nullptr) ? (uint32_t)(row - rv_decode_table) : RV_DECODE_ROWS;
+            m_log.push_back({instr, (uint32_t)cls, idx, diff, res.ctrl, exp.ctrl});
+        }
+    }
+
+    uint32_t                m_id;
+    TOP_CLASS*              m_top;
+    uint64_t                m_counts[DECODE_CLASSES];
+    uint32_t                m_logged[DECODE_CLASSES];
+    std::vector<uint64_t>   m_hits;
+    std::vector<DecodeLog>  m_log;
+};
+
+static std::string decode_diff_str(const DecodeLog& l)
+{
+    std::string str;
+    for (int i=0 ; i<DEC_DIFF_FIELDS ; ++i)
+    {
+        if (l.diff & (1u << i))
+        {
+            str += (str.empty() ? "" : "|") + std::string(rv_decode_diff_names[i]);
+        }
+    }
+    if ((l.diff & DEC_DIFF_CTRL) && (l.row < RV_DECODE_ROWS))
+    {
+        const RvDecodeRow& row = rv_decode_table[l.row];
+        uint32_t bits = (l.ctrl ^ l.ctrl_exp) & row.care;
+        for (int i=0 ; i<DEC_CTRL_BITS ; ++i)
+        {
+            if (bits & (1u << i))
+            {
+                str += std::string(":") + rv_decode_ctrl_names[i];
+            }
+        }
+    }
+    return str;
+}
+
+int main(int argc, char** argv, char** env)
+{
+    TB* tb = new TB(TOP_NAME_STR, argc, argv);
+    tb->init(on_step_cb);
+    TOP_CLASS* top = tb->get_top();
+    VerilatedContext* ctx = tb->get_context();
+
+    // +seed=N, +lanes=N (host threads by default), +samples=N per combination,
+    // +log=<file>, +strict - unflagged encodings fail
+    uint64_t seed = plusarg_u64(ctx, "seed", 1);
+    uint32_t lanes = plusarg_u64(ctx, "lanes", std::thread::hardware_concurrency());
+    uint32_t samples = plusarg_u64(ctx, "samples", SAMPLES_DEFAULT);
+    const char* log_name = plusarg_str(ctx, "log");
+    bool strict = plusarg_flag(ctx, "strict");
+    lanes = (lanes == 0) ? 1 : lanes;
+    printf("Seed %lu, %u lanes, %u samples per opcode/funct3/funct7.\n", seed, lanes, samples);
+
+    // lane 0 drives the model of the TB, the others own a model and a context each
+    std::vector<std::unique_ptr<VerilatedContext>> contexts;
+    std::vector<std::unique_ptr<TOP_CLASS>> models;
+    std::vector<std::unique_ptr<DecodeLane>> lane_list;
+    lane_list.emplace_back(new DecodeLane(0, top));
+    for (uint32_t i=1 ; i<lanes ; ++i)
+    {
+        contexts.emplace_back(new VerilatedContext);
+        contexts.back()->commandArgs(argc, argv);
+        models.emplace_back(new TOP_CLASS(contexts.back().get(), TOP_NAME_STR));
+        lane_list.emplace_back(new DecodeLane(i, models.back().get()));
+    }
+
+    auto start = std::chrono::system_clock::now();
+    std::vector<std::thread> threads;
+    for (auto& lane : lane_list)
+    {
+        DecodeLane* p = lane.get();
+        threads.emplace_back([p, lanes, samples, seed]() {
+            p->run(lanes, samples, seed);
+        });
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+    auto end = std::chrono::system_clock::now();
+    std::chrono::duration<double> elapsed_seconds = end-start;
+
+    FILE* f_log = fopen((log_name != nullptr) ? log_name : LOG_DEFAULT, "w");
+    if (f_log != nullptr)
+    {
+        fprintf(f_log, "instr,class,name,diff\n");
+    }
+    uint64_t counts[DECODE_CLASSES] = {0};
+    for (auto& lane : lane_list)
+    {
+        for (int c=0 ; c<DECODE_CLASSES ; ++c)
+        {
+            counts[c] += lane->get_count(c);
+        }
+        for (const DecodeLog& l : lane->get_log())
+        {
+            if (f_log != nullptr)
+            {
+                fprintf(f_log, "0x%08x,%s,%s,%s\n", l.instr, decode_class_names[l.cls],
+                        (l.row < RV_DECODE_ROWS) ? rv_decode_table[l.row].name : "",
+                        decode_diff_str(l).c_str());
+            }
+        }
+    }
+    if (f_log != nullptr)
+    {
+        fclose(f_log);
+    }
+
+    // every canonical instruction must be hit by the sweep
+    uint32_t missed = 0;
+    for (uint32_t r=0 ; r<RV_DECODE_ROWS ; ++r)
+    {
+        uint64_t hits = 0;
+        for (auto& lane : lane_list)
+        {
+            hits += lane->get_hits(r);
+        }
+        if (hits == 0)
+        {
+            printf("Not covered: %s\n", rv_decode_table[r].name);
+            ++missed;
+        }
+    }
+
+    int ret = ((counts[DECODE_MISMATCH] != 0) || (counts[DECODE_FLAGGED] != 0) || (missed != 0) ||
+               (strict && (counts[DECODE_UNFLAGGED] != 0))) ? 1 : 0;
+
+    uint64_t total = 0;
+    for (int c=0 ; c<DECODE_CLASSES ; ++c)
+    {
+        printf("%-10s %10lu\n", decode_class_names[c], counts[c]);
+        total += counts[c];
+    }
+    printf("Simulation time: %.3f(s) Iterations: %lu\n", elapsed_seconds.count(), total);
+    printf("Simulation result: %s\n", (ret == 0) ? "PASS" : "FAIL");
+
+    for (auto& model : models)
+    {
+        model->final();
+    }
+    tb->finish();
+    top->final();
+#if VM_COVERAGE
+    //tb->get_context()->coveragep()->write(COV_FN);
+#endif
+    return ret;
+}
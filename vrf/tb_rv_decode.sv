@@ -0,0 +1,112 @@
+`timescale 1ps/1ps
+
+`include "../rtl/rv_structs.vh"
+
+// Unbuffered rv_decode for vrf/tb_rv_decode.cpp, struct outputs are flattened.
+module tb_rv_decode
+(
+    input   wire[31:0]                  i_instruction,
+    input   wire[31:1]                  i_pc,
+    input   wire[31:1]                  i_pc_next,
+    output  wire[11:0]                  o_csr_idx,
+    output  wire[4:0]                   o_csr_imm,
+    output  wire                        o_csr_write,
+    output  wire                        o_csr_set,
+    output  wire                        o_csr_clear,
+    output  wire                        o_csr_read,
+    output  wire                        o_csr_ebreak,
+    output  wire[31:1]                  o_pc,
+    output  wire[31:1]                  o_pc_next,
+    output  wire[4:0]                   o_rs1,
+    output  wire[4:0]                   o_rs2,
+    output  wire[4:0]                   o_rd,
+    output  wire[31:0]                  o_imm_i,
+    output  wire[2:0]                   o_funct3,
+    output  wire                        o_alu_add_override,
+    output  wire                        o_alu_op2_inverse,
+    output  wire                        o_alu_sh_ar,
+    output  wire                        o_alu_group_mux,
+    output  wire                        o_alu_div_mux,
+    output  wire                        o_res_memory,
+    output  wire                        o_res_pc_next,
+    output  wire                        o_res_alu,
+    output  wire                        o_reg_write,
+    output  wire                        o_op1_src,
+    output  wire                        o_op2_src,
+    output  wire                        o_inst_mret,
+    output  wire                        o_inst_jalr,
+    output  wire                        o_inst_jal,
+    output  wire                        o_inst_branch,
+    output  wire                        o_inst_store,
+    output  wire                        o_inst_supported
+);
+
+    alu_ctrl_t  alu_ctrl;
+    res_src_t   res_src;
+
+    /* verilator lint_off PINCONNECTEMPTY */
+    rv_decode
+    #(
+        .IADDR_SPACE_BITS               (32),
+        .EXTENSION_C                    (1),
+        .EXTENSION_F                    (0),
+        .EXTENSION_M                    (1),
+        .EXTENSION_Zicsr                (1),
+        .BUFFERED                       (0)
+    )
+    u_dut
+    (
+        .i_clk                          (1'b0),
+        .i_stall                        (1'b0),
+        .i_flush                        (1'b0),
+        .i_instruction                  (i_instruction),
+        .i_ready                        (1'b1),
+        .i_pc                           (i_pc),
+        .i_pc_next                      (i_pc_next),
+        .i_pred                         (1'b0),
+        .i_pred_target                  ('0),
+        .i_pred_idx                     ('0),
+`ifdef TO_SIM
+        .o_instr                        (),
+`endif
+        .o_csr_idx                      (o_csr_idx),
+        .o_csr_imm                      (o_csr_imm),
+        .o_csr_write                    (o_csr_write),
+        .o_csr_set                      (o_csr_set),
+        .o_csr_clear                    (o_csr_clear),
+        .o_csr_read                     (o_csr_read),
+        .o_csr_ebreak                   (o_csr_ebreak),
+        .o_pc                           (o_pc),
+        .o_pc_next                      (o_pc_next),
+        .o_pred                         (),
+        .o_pred_target                  (),
+        .o_pred_idx                     (),
+        .o_rs1                          (o_rs1),
+        .o_rs2                          (o_rs2),
+        .o_rd                           (o_rd),
+        .o_imm_i                        (o_imm_i),
+        .o_funct3                       (o_funct3),
+        .o_alu_ctrl                     (alu_ctrl),
+        .o_res_src                      (res_src),
+        .o_reg_write                    (o_reg_write),
+        .o_op1_src                      (o_op1_src),
+        .o_op2_src                      (o_op2_src),
+        .o_inst_mret                    (o_inst_mret),
+        .o_inst_jalr                    (o_inst_jalr),
+        .o_inst_jal                     (o_inst_jal),
+        .o_inst_branch                  (o_inst_branch),
+        .o_inst_store                   (o_inst_store),
+        .o_inst_supported               (o_inst_supported)
+    );
+    /* verilator lint_on PINCONNECTEMPTY */
+
+    assign  o_alu_add_override = alu_ctrl.add_override;
+    assign  o_alu_op2_inverse = alu_ctrl.op2_inverse;
+    assign  o_alu_sh_ar = alu_ctrl.sh_ar;
+    assign  o_alu_group_mux = alu_ctrl.group_mux;
+    assign  o_alu_div_mux = alu_ctrl.div_mux;
+    assign  o_res_memory = res_src.memory;
+    assign  o_res_pc_next = res_src.pc_next;
+    assign  o_res_alu = res_src.alu;
+
+endmodule
@@ -1,57 +1,58 @@
 #include <memory>
 #include <chrono>
-#include <ctime> 
-#include <iomanip>
-#include <fstream>
-#include <fmt/format.h>
-#include <jsoncpp/json/json.h>
+#include <ctime>
+#include <cstdio>
 #include "tb.h"
+#include "sim_args.h"
+#include "rv_iss.h"
 
 double sc_time_stamp() { return 0; }
 
-#define TICK_TIME 10
-#define TICK_PERIOD (TICK_TIME / 2)
-#define SIM_TIME_MAX (1000*10)
-#define SIM_TIME_MAX_TICK (TICK_TIME * SIM_TIME_MAX)
+// upper half of the input, the decoder must ignore it for compressed encodings
+#define INSTR_HI        0x5aff0000
+#define ENCODINGS       0x10000
+#define LOG_DEFAULT     TOP_NAME_STR ".csv"
 
-#define SIM_PULSE_DELTA 1000000
-
-uint32_t prev_marker;
-bool initialized;
+// Every 16-bit encoding is checked against rv_expand_c() of the ISS:
+//  mismatch    - legal encoding, wrong expansion
+//  flagged     - legal encoding reported as illegal
+//  unflagged   - reserved or illegal in RV32IC (e.g. c.fld, c.lui with zero
+//                immediate), not reported as illegal; a failure with +strict
+// 32-bit encodings must pass through with the illegal flag set.
+enum DecodeClass
+{
+    DECODE_OK,
+    DECODE_MISMATCH,
+    DECODE_FLAGGED,
+    DECODE_UNFLAGGED,
+    DECODE_CLASSES
+};
 
-Json::Value json_cmp;
-Json::Value json_res;
+static const char* const decode_class_names[DECODE_CLASSES] = {
+    "ok", "mismatch", "flagged", "unflagged"
+};
 
-int on_step_cb(uint64_t time, TOP_CLASS* p_top)
+static DecodeClass decode_check(uint32_t instr, uint32_t result, bool illegal, uint32_t& expected)
 {
-    if ((time % SIM_PULSE_DELTA) == 0)
+    if ((instr & 3) == 3)
     {
-        std::cout << "SIM: running, time" << time << std::endl;
+        expected = instr;
+        return (illegal && (result == instr)) ? DECODE_OK : DECODE_MISMATCH;
     }
-    if ((time % 2) == 0)
+    expected = rv_expand_c(instr & 0xffff);
+    if (expected == 0)
     {
-        int idx = json_res.size();
-        uint32_t data_cmp;
-        std::stringstream ss;
-        ss << std::hex << json_cmp[idx]["uncomp"].asString().substr(2);
-        ss >> data_cmp;
-        data_cmp &= 0xffff;
-
-        Json::Value val;
-        val["comp"] = fmt::format("0x{:x}", p_top->i_instruction);
-        val["uncomp_exp"] = json_cmp[idx]["uncomp"];
-        val["uncomp"] = fmt::format("0x{:x}", p_top->o_instruction);
-        val["invalid"] = p_top->o_illegal_instruction;
-        json_res.append(val);
-
-        uint32_t data = p_top->o_instruction & 0xffff;
-        if (data_cmp != data)
-        {
-            std::cout << "Expected value: " << std::hex << data_cmp << std::dec << std::endl;
-            std::cout << "Get value:      " << std::hex << data << std::dec << std::endl;
-            return 1;
-        }
+        return illegal ? DECODE_OK : DECODE_UNFLAGGED;
     }
+    if (illegal)
+    {
+        return DECODE_FLAGGED;
+    }
+    return (result == expected) ? DECODE_OK : DECODE_MISMATCH;
+}
+
+int on_step_cb(uint64_t time, TOP_CLASS* p_top)
+{
     return 0;
 }
 
@@ -60,41 +61,51 @@ int main(int argc, char** argv, char** env)
     TB* tb = new TB(TOP_NAME_STR, argc, argv);
     tb->init(on_step_cb);
     TOP_CLASS* top = tb->get_top();
-    int ret = 0;
+    VerilatedContext* ctx = tb->get_context();
 
-    std::ifstream f_in;
-    f_in.open("../" TOP_NAME_STR ".json", std::ios::out);
-    Json::Reader reader;
-    if (!reader.parse(f_in, json_cmp, false))
+    // +log=<file> - CSV of the encodings which aren't ok, +strict - unflagged ones fail
+    const char* log_name = plusarg_str(ctx, "log");
+    bool strict = plusarg_flag(ctx, "strict");
+    FILE* f_log = fopen((log_name != nullptr) ? log_name : LOG_DEFAULT, "w");
+    if (f_log == nullptr)
     {
-        std::cout << "Unable to read valid result from file!" << std::endl;
+        printf("Unable to create log file!\n");
         return -1;
     }
-    f_in.close();
+    fprintf(f_log, "instr,class,expected,result,illegal\n");
 
+    uint64_t counts[DECODE_CLASSES] = {0};
     auto start = std::chrono::system_clock::now();
     uint32_t i;
-    for (i=0 ; i<0x10000 ; ++i)
+    for (i=0 ; i<ENCODINGS ; ++i)
     {
-        top->i_instruction = (0x5aff0000 | i);
-        if (tb->run_steps(2)  > 0)
+        uint32_t instr = INSTR_HI | i;
+        top->i_instruction = instr;
+        tb->run_steps(1);
+        uint32_t result = top->o_instruction;
+        bool illegal = top->o_illegal_instruction;
+        uint32_t expected;
+        DecodeClass cls = decode_check(instr, result, illegal, expected);
+        ++counts[cls];
+        if (cls != DECODE_OK)
         {
-            ret = 1;
-            break;
+            fprintf(f_log, "0x%08x,%s,0x%08x,0x%08x,%d\n",
+                    instr, decode_class_names[cls], expected, result, illegal);
         }
     }
     auto end = std::chrono::system_clock::now();
     std::chrono::duration<double> elapsed_seconds = end-start;
+    fclose(f_log);
 
-    std::ofstream f_out;
-    f_out.open("./" TOP_NAME_STR ".json", std::ios::out);
-    Json::StyledStreamWriter writer("\t");
-    writer.write(f_out, json_res);
-    f_out.close();
+    int ret = ((counts[DECODE_MISMATCH] != 0) || (counts[DECODE_FLAGGED] != 0) ||
+               (strict && (counts[DECODE_UNFLAGGED] != 0))) ? 1 : 0;
 
-    std::cout << std::setprecision(3) << "Simulation time: " << elapsed_seconds.count() <<
-        " Iterations: " << i << std::endl;
-    std::cout << "Simulation result: " << ((ret == 0) ? "PASS" : "FAIL") << std::endl;
+    for (int c=0 ; c<DECODE_CLASSES ; ++c)
+    {
+        printf("%-10s %6lu\n", decode_class_names[c], counts[c]);
+    }
+    printf("Simulation time: %.3f(s) Iterations: %u\n", elapsed_seconds.count(), i);
+    printf("Simulation result: %s\n", (ret == 0) ? "PASS" : "FAIL");
 
     tb->finish();
     top->final();
@@ -1,7 +1,37 @@
 #include <memory>
 #include <chrono>
-#include <ctime> 
+#include <ctime>
+#include <algorithm>
 #include "tb.h"
+#include "sim_args.h"
+#include "sim_run.h"
+#include "sim_elf.h"
+#include "sim_tcm.h"
+#include "sim_checkpoint.h"
+#include "sim_console.h"
+#include "sim_mailbox.h"
+#include "sim_retire.h"
+#include "sim_cosim.h"
+#include "sim_ffwd.h"
+#include "sim_trace_bin.h"
+#include "sim_summary.h"
+#include "sim_bus_delay.h"
+#include "sim_cpi.h"
+#include "sim_profile.h"
+#include "sim_mix.h"
+#include "../fw/common/sim.h"
+#if SIM_WAVES
+#include "sim_waves.h"
+#endif
+
+// TB dumps every signal on every time step (trace=1), while a waves=1 model
+// runs the cycle loop and the harness decides what to dump (sim_waves.h)
+#define SIM_TB_TRACE (VM_TRACE && !SIM_WAVES)
+
+// --threads count of the model (threads=N), the run time pool can't be smaller
+#ifndef SIM_THREADS
+#define SIM_THREADS 1
+#endif
 
 uint64_t cur_ts;
 
@@ -16,92 +46,634 @@ double sc_time_stamp()
 #define SIM_TIME_MAX_TICK (TICK_TIME * SIM_TIME_MAX)
 
 #define SIM_PULSE_DELTA 1000000
+#define SIM_PULSE_CYCLES (SIM_PULSE_DELTA / TICK_TIME)
+#define SIM_BATCH_CYCLES 4096
+
+#define SIM_COMM_ADDR 0xf0000000
+#define SIM_RESET_ADDR 0x00000000
+#define SIM_RESET_CYCLES 20
 
 uint32_t prev_marker;
 bool initialized;
+VerilatedContext* sim_ctx;
+SimRun* sim_run;
+uint32_t markers;
+uint32_t save_marker;
+bool save_pending;
+SimConsole console;
+SimMailbox mailbox(&console);
+SimMix* mix;
 
-int on_step_cb(uint64_t time, TOP_CLASS* p_top)
+// DPI import of vrf/sim_mailbox.sv
+void mailbox_xfer(int ch, int addr, int len)
 {
-    cur_ts = time;
-    if ((time % SIM_PULSE_DELTA) == 0)
+    mailbox.xfer(ch & (SIM_MAILBOX_CHANNELS - 1), addr, len);
+}
+
+#if SIM_TCM_DPI
+// DPI imports of vrf/tcm_dpi.sv, the memory is shared with the loader and the mailbox
+void tcm_dpi_init(int addr_width)
+{
+    if ((4u << addr_width) != TCM_SIZE)
     {
-        printf("SIM: running, time %ld ticks, WB_ADDR=0x%08x\n", time, p_top->o_wb_addr);
+        printf("SIM: tcm_dpi size (%d address bits) doesn't match TCM_SIZE\n", addr_width);
     }
-    if ((time % TICK_PERIOD) == 0)
+}
+
+void tcm_dpi_load(const char* file_name)
+{
+    sim_tcm_mem().load_hex(file_name);
+}
+
+int tcm_dpi_read(int idx)
+{
+    return sim_tcm_mem().read32((uint32_t)idx << 2);
+}
+
+void tcm_dpi_write(int idx, int data, int sel)
+{
+    sim_tcm_mem().write32((uint32_t)idx << 2, data, sel);
+}
+#endif
+
+SimBusDelay bus_delay;
+
+// DPI imports of vrf/sim_bus_delay.sv
+svBit bus_delay_enabled(int slave)
+{
+    return bus_delay.enabled(slave) ? 1 : 0;
+}
+
+int bus_delay_waits(int slave, int addr)
+{
+    return bus_delay.waits(slave, addr);
+}
+
+int bus_delay_random(int slave)
+{
+    return bus_delay.random(slave);
+}
+
+SimRetire retire;
+SimCpi cpi;
+SimProfile* profile;
+SimCosim* cosim;
+SimTraceBin trace_bin;
+#if SIM_WAVES
+SimWaves waves;
+
+void on_eval_cb(uint64_t time)
+{
+    waves.dump(time);
+}
+#endif
+
+// DPI import of rtl/core/rv_trace.sv, called on every retired instruction once enabled
+void trace_retire(int pc, int instr, svBit reg_write, int reg_data, svBit mem_read, svBit mem_write,
+    int mem_addr, int mem_wdata, int mem_rdata, int mem_sel, int rd_old, int flags)
+{
+    uint64_t time = sim_ctx->time();
+    RetireInfo info = { time / TICK_TIME, (uint32_t)pc, (uint32_t)instr, reg_write != 0,
+        (uint32_t)reg_data, mem_read != 0, mem_write != 0, (uint32_t)mem_addr, (uint32_t)mem_wdata,
+        (uint32_t)mem_rdata, (uint32_t)mem_sel, time, (uint32_t)rd_old, (uint32_t)flags };
+    retire.retire(info);
+}
+
+void trace_event(int id)
+{
+    retire.event(sim_ctx->time(), (uint32_t)id);
+}
+
+// Firmware write into COMM_ADDR, see fw/common/sim.c.
+int on_comm_write(uint64_t cycle, uint32_t data)
+{
+    uint32_t marker = data >> 8;
+    uint32_t ch = data & 0xff;
+    if (marker == prev_marker)
+    {
+        return 0;
+    }
+    prev_marker = marker;
+    if ((ch & 0xf0) != 0xf0)
     {
-        if (((p_top->o_debug & 0x1) == 1) && initialized)
+        console.put(ch);
+        return 0;
+    }
+    console.flush();
+    switch (ch)
+    {
+    // exit codes
+    case 0xf0:
+        printf("Finished. Ok.\n");
+        return 1;
+    case 0xf1:
+        printf("Finished. Failed.\n");
+        return -1;
+    case SIM_MARKER:
+        ++markers;
+        printf("SIM: marker %d at cycle %ld\n", markers, cycle);
+        cpi.on_marker(markers);
+        if (mix != nullptr)
         {
-            printf("Finished. Undefined instruction\n");
-            return -1;
+            mix->on_marker(markers);
+        }
+        if (profile != nullptr)
+        {
+            profile->on_marker(markers);
+        }
+#if SIM_WAVES
+        waves.on_marker(cycle, markers);
+#endif
+        if (markers == save_marker)
+        {
+            save_pending = true;
+            sim_run->request_stop();
+        }
+        break;
+    }
+    return 0;
+}
+
+int on_edge_cb(uint64_t cycle, TOP_CLASS* p_top)
+{
+    cur_ts = sim_ctx->time();
+#if SIM_WAVES
+    waves.on_cycle(cycle);
+#endif
+    if (retire.get_status() != 0)
+    {
+        console.flush();
+        return retire.get_status();
+    }
+    if (initialized)
+    {
+        cpi.on_cycle(p_top->o_debug);
+    }
+    // only write cycles can carry console output or exit code
+    if ((p_top->o_wb_we == 1) && (p_top->o_wb_addr == SIM_COMM_ADDR))
+    {
+        int ret = on_comm_write(cycle, p_top->o_wb_wdata);
+        if (ret != 0)
+        {
+            return ret;
         }
-        if ((p_top->o_wb_addr == 0xf0000000) && (p_top->o_wb_we == 1) && (p_top->i_clk))
+    }
+    if ((cycle % SIM_PULSE_CYCLES) == 0)
+    {
+        console.flush();
+        printf("SIM: running, time %ld ticks, WB_ADDR=0x%08x\n", cur_ts, p_top->o_wb_addr);
+    }
+    if (((p_top->o_debug & 0x1) == 1) && initialized)
+    {
+        console.flush();
+        printf("Finished. Undefined instruction\n");
+        return -1;
+    }
+    return 0;
+}
+
+// Copies PT_LOAD segments of the firmware image into the TCM. Only file-backed
+// part is written, .bss relies on the zero-initialized model memory.
+bool load_elf(const char* file_name)
+{
+    ElfFile elf;
+    if (!elf.load(file_name))
+    {
+        return false;
+    }
+    for (uint32_t i=0 ; i<elf.get_segments_count() ; ++i)
+    {
+        const Elf32_Phdr* seg = elf.get_segment(i);
+        if ((seg->p_type != PT_LOAD) || (seg->p_filesz == 0))
+        {
+            continue;
+        }
+        const uint8_t* data = elf.get_segment_data(seg);
+        if (data == nullptr)
         {
-            uint32_t data = p_top->o_wb_wdata;
-            uint32_t marker = data >> 8;
-            uint32_t ch = data & 0xff;
-            if (marker != prev_marker)
+            printf("ELF: segment %d is out of file\n", i);
+            return false;
+        }
+        if (!sim_tcm_contains(seg->p_paddr, seg->p_filesz))
+        {
+            printf("ELF: segment %d (0x%08x, %d bytes) is out of TCM, skipped\n", i,
+                seg->p_paddr, seg->p_filesz);
+            continue;
+        }
+        sim_tcm_write(seg->p_paddr, data, seg->p_filesz);
+    }
+    return true;
+}
+
+// Writes the begin_signature..end_signature region of an arch test, one word per
+// line as the .reference_output files of riscv-arch-test.
+bool dump_signature(const char* elf_name, const char* file_name)
+{
+    ElfFile elf;
+    uint32_t begin, end;
+    if ((elf_name == nullptr) || !elf.load(elf_name) ||
+        !elf.find_symbol("begin_signature", begin) || !elf.find_symbol("end_signature", end))
+    {
+        printf("SIM: +signature needs an +elf= image with begin/end_signature symbols\n");
+        return false;
+    }
+    if ((end < begin) || !sim_tcm_contains(begin, end - begin))
+    {
+        printf("SIM: signature region 0x%08x..0x%08x is out of TCM\n", begin, end);
+        return false;
+    }
+    FILE* f = fopen(file_name, "w");
+    if (f == nullptr)
+    {
+        printf("SIM: unable to create '%s'\n", file_name);
+        return false;
+    }
+    for (uint32_t addr=begin ; addr<end ; addr+=4)
+    {
+        fprintf(f, "%08x\n", sim_tcm_read32(addr));
+    }
+    fclose(f);
+    return true;
+}
+
+// ISS stores out of the TCM during fast-forward, only the console is served
+int ffwd_store_cb(uint32_t addr, uint32_t data)
+{
+    return (addr == SIM_COMM_ADDR) ? on_comm_write(0, data) : 0;
+}
+
+// per-time-unit callback, used only for traced runs where TB dumps waveforms
+int on_step_cb(uint64_t time, TOP_CLASS* p_top)
+{
+    cur_ts = time;
+    if ((time % TICK_PERIOD) == 0)
+    {
+        if (p_top->i_clk)
+        {
+            int ret = on_edge_cb(time / TICK_TIME, p_top);
+            if (ret != 0)
             {
-                if ((ch & 0xf0) == 0xf0)
-                {
-                    // exit code
-                    switch (ch)
-                    {
-                    case 0xf0:
-                        printf("Finished. Ok.\n");
-                        return 1;
-                    case 0xf1:
-                        printf("Finished. Failed.\n");
-                        return -1;
-                    }
-                }
-                else
-                {
-                    printf("%c", ch);
-                }
-                prev_marker = marker;
+                return ret;
             }
         }
-
         p_top->i_clk = !p_top->i_clk;
     }
     return 0;
 }
 
+// record name of the run summary, +summary_name=<name> or the firmware ELF name
+std::string summary_name()
+{
+    const char* name = plusarg_str(sim_ctx, "summary_name");
+    if (name != nullptr)
+    {
+        return name;
+    }
+    const char* elf_name = plusarg_str(sim_ctx, "elf");
+    if (elf_name == nullptr)
+    {
+        return TOP_NAME_STR;
+    }
+    std::string base(elf_name);
+    base = base.substr(base.find_last_of('/') + 1);
+    return base.substr(0, base.rfind('.'));
+}
+
+double seconds_between(std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to)
+{
+    return std::chrono::duration<double>(to - from).count();
+}
+
 int main(int argc, char** argv, char** env)
 {
+    auto t_begin = std::chrono::system_clock::now();
+    // thread pool of a multi-threaded model (threads=N) must be sized before it's created
+    unsigned threads = argv_u64(argc, argv, "threads", 0);
+    if ((threads != 0) && (threads < SIM_THREADS))
+    {
+        printf("SIM: +threads=%d is below the model's %d thread(s), using %d\n", threads, SIM_THREADS, SIM_THREADS);
+        threads = SIM_THREADS;
+    }
+    if (threads != 0)
+    {
+        Verilated::defaultContextp()->threads(threads);
+    }
     TB* tb = new TB(TOP_NAME_STR, argc, argv);
     tb->init(on_step_cb);
     TOP_CLASS* top = tb->get_top();
+    sim_ctx = tb->get_context();
+    if ((threads != 0) && (sim_ctx->threads() != threads))
+    {
+        printf("SIM: +threads=%d not applied, model uses %d thread(s)\n", threads, sim_ctx->threads());
+    }
+    // wait states are read by initial blocks, so before the first evaluation
+    bus_delay.init(sim_ctx);
+    auto t_model = std::chrono::system_clock::now();
     prev_marker = 0x5a5a;
     initialized = false;
+    markers = 0;
+    save_pending = false;
 
-    const char* cycles_str = tb->get_context()->commandArgsPlusMatch("cycles");
-    uint32_t cycles = (uint32_t)-1;
-    if (strlen(cycles_str) > 8)
+    const char* console_log = plusarg_str(sim_ctx, "console_log");
+    if (console_log != nullptr)
     {
-        cycles_str += 8;
-        cycles = atoi(cycles_str);
+        console.open_log(console_log);
     }
+
+    uint64_t cycles = plusarg_u64(sim_ctx, "cycles", (uint32_t)-1);
+    SimRun run(tb, TICK_TIME, on_edge_cb);
+    sim_run = &run;
+
+    // checkpoint is stored at +save_cycle=N, otherwise at N-th firmware marker (+save_marker=N)
+    const char* save_name = plusarg_str(sim_ctx, "save");
+    uint64_t save_cycle = plusarg_u64(sim_ctx, "save_cycle", 0);
+    save_marker = (save_name != nullptr) && (save_cycle == 0) ? plusarg_u64(sim_ctx, "save_marker", 1) : 0;
+    const char* restore_name = plusarg_str(sim_ctx, "restore");
+#if SIM_TB_TRACE
+    if ((save_name != nullptr) || (restore_name != nullptr))
+    {
+        printf("SIM: checkpoints aren't supported by traced runs\n");
+        save_name = restore_name = nullptr;
+        save_marker = 0;
+    }
+#endif
+
+    // CPI stack, +cpi from the reset release, +cpi_marker=N from the N-th firmware marker
+    // (implies +cpi), +cpi_stop_marker=N up to the N-th one
+    uint32_t cpi_marker = plusarg_u64(sim_ctx, "cpi_marker", 0);
+    cpi.init(plusarg_flag(sim_ctx, "cpi") || (cpi_marker != 0), cpi_marker,
+        plusarg_u64(sim_ctx, "cpi_stop_marker", 0));
+    if (cpi.is_active())
+    {
+        // base cycles are the retirements
+        retire.add(&cpi);
+    }
+
+    // function profile of the retire stream, +prof [+prof_elf=<file>] [+prof_period=N]
+    // [+prof_marker=N] [+prof_top=N] [+prof_folded=<file>]
+    if (plusarg_flag(sim_ctx, "prof"))
+    {
+        const char* prof_elf = plusarg_str(sim_ctx, "prof_elf");
+        profile = new SimProfile();
+        if (profile->init((prof_elf != nullptr) ? prof_elf : plusarg_str(sim_ctx, "elf"),
+            plusarg_u64(sim_ctx, "prof_period", 1), plusarg_u64(sim_ctx, "prof_marker", 0)))
+        {
+            retire.add(profile);
+        }
+        else
+        {
+            delete profile;
+            profile = nullptr;
+        }
+    }
+
+    // instruction mix of the retire stream, a region per firmware marker
+    if (plusarg_flag(sim_ctx, "mix"))
+    {
+        mix = new SimMix();
+        retire.add(mix);
+    }
+
+    // lockstep comparison against the reference ISS
+    if (plusarg_flag(sim_ctx, "cosim"))
+    {
+        if (restore_name == nullptr)
+        {
+            cosim = new SimCosim();
+            retire.add(cosim);
+        }
+        else
+        {
+            printf("SIM: +cosim needs a run from reset, ignored with +restore\n");
+        }
+    }
+    // binary retire trace instead of trace.txt, see sim/trace_decode.py
+    const char* trace_bin_name = plusarg_str(sim_ctx, "trace_bin");
+    if (trace_bin_name != nullptr)
+    {
+        if (!trace_bin.open(trace_bin_name))
+        {
+            tb->finish();
+            return -1;
+        }
+        retire.add(&trace_bin);
+    }
+#if SIM_WAVES
+    // +waves_fst=<file> [+waves_start=N] [+waves_stop=N] [+waves_pc=<addr>|+waves_marker=N]
+    // [+waves_pre=N] [+waves_post=N] [+waves_scope=<scope>,...]
+    const char* waves_name = plusarg_str(sim_ctx, "waves_fst");
+    if (waves_name != nullptr)
+    {
+        waves.init(top, sim_ctx, waves_name, plusarg_str(sim_ctx, "waves_scope"));
+        waves.set_window(plusarg_u64(sim_ctx, "waves_start", 0),
+            plusarg_u64(sim_ctx, "waves_stop", WAVES_NEVER));
+        if (plusarg_str(sim_ctx, "waves_pc") != nullptr)
+        {
+            waves.set_pc_trigger(plusarg_u64(sim_ctx, "waves_pc", 0));
+            retire.add(&waves);
+        }
+        waves.set_marker_trigger(plusarg_u64(sim_ctx, "waves_marker", 0));
+        waves.set_pre(plusarg_u64(sim_ctx, "waves_pre", 0));
+        waves.set_post(plusarg_u64(sim_ctx, "waves_post", WAVES_NEVER));
+        run.set_eval_cb(on_eval_cb);
+    }
+#endif
     auto start = std::chrono::system_clock::now();
+    auto t_loaded = start;
+    auto t_reset = start;
+
+    if (restore_name != nullptr)
+    {
+        SimState state;
+        if (!sim_checkpoint_restore(restore_name, top, state))
+        {
+            tb->finish();
+            return -1;
+        }
+        sim_ctx->time(state.time);
+        cur_ts = state.time;
+        run.set_cycle(state.cycle);
+        prev_marker = state.prev_marker;
+        markers = state.markers;
+        if (mix != nullptr)
+        {
+            mix->on_marker(markers);
+        }
+        initialized = true;
+        // enable state of the retire stream is restored with the model
+        retire.enable();
+        t_loaded = t_reset = std::chrono::system_clock::now();
+    }
+    else
+    {
+        // firmware image (+elf=) is loaded and retire stream is enabled after initial
+        // blocks have been evaluated
+        top->eval();
+        const char* elf_name = plusarg_str(sim_ctx, "elf");
+        if ((elf_name != nullptr) && !load_elf(elf_name))
+        {
+            tb->finish();
+            return -1;
+        }
+        retire.enable();
 
-    // wait for reset
-    top->i_reset_n = 0;
-    tb->run_steps(20 * TICK_TIME);
-    top->i_reset_n = 1;
-    initialized = true;
+        // fast-forward by the ISS up to +ffwd_pc=<addr> (+ffwd_pc_hits=N) or +ffwd_instret=N
+        RvIss* ffwd_iss = nullptr;
+        SimFfwdPoint point;
+        point.use_pc = (plusarg_str(sim_ctx, "ffwd_pc") != nullptr);
+        point.pc = plusarg_u64(sim_ctx, "ffwd_pc", 0);
+        point.pc_hits = plusarg_u64(sim_ctx, "ffwd_pc_hits", 1);
+        point.instret = plusarg_u64(sim_ctx, "ffwd_instret", point.use_pc ? (uint64_t)-1 : 0);
+        if (point.use_pc || (point.instret != 0))
+        {
+            ffwd_iss = new RvIss(TCM_BASE, TCM_SIZE);
+            sim_tcm_read(TCM_BASE, ffwd_iss->get_mem(), TCM_SIZE);
+            ffwd_iss->reset(SIM_RESET_ADDR);
+            int ffwd_ret = sim_ffwd_run(*ffwd_iss, point, ffwd_store_cb);
+            if (ffwd_ret != 0)
+            {
+                console.close();
+                tb->finish();
+                return (ffwd_ret == 1) ? 0 : -1;
+            }
+            sim_ffwd_inject_arch(*ffwd_iss);
+        }
+        if (cosim != nullptr)
+        {
+            if (ffwd_iss != nullptr)
+            {
+                cosim->start_from(*ffwd_iss);
+            }
+            else
+            {
+                cosim->start(SIM_RESET_ADDR);
+            }
+        }
+
+        t_loaded = std::chrono::system_clock::now();
+
+        // wait for reset
+        top->i_reset_n = 0;
+#if SIM_TB_TRACE
+        tb->run_steps(SIM_RESET_CYCLES * TICK_TIME);
+#else
+        run.run_cycles(SIM_RESET_CYCLES);
+#endif
+        top->i_reset_n = 1;
+        initialized = true;
+
+        if (ffwd_iss != nullptr)
+        {
+            // machine CSRs are injected as soon as the core leaves reset
+            for (int i=0 ; (i<SIM_RESET_CYCLES) && sim_ffwd_core_in_reset() ; ++i)
+            {
+#if SIM_TB_TRACE
+                tb->run_steps(TICK_TIME);
+#else
+                run.run_cycles(1);
+#endif
+            }
+            sim_ffwd_inject_csr(*ffwd_iss);
+            delete ffwd_iss;
+        }
+        t_reset = std::chrono::system_clock::now();
+    }
 
     int ret = -1;
-    uint32_t cycles_cnt = 0;
-    for ( ; cycles_cnt<cycles ; ++cycles_cnt)
+    uint64_t cycles_cnt = 0;
+#if SIM_TB_TRACE
+    bool step_loop = true;
+#else
+    // +step_loop, the per-time-unit loop of TB::run_steps(), a baseline for cycles/s figures
+    bool step_loop = plusarg_flag(sim_ctx, "step_loop");
+    if (step_loop && (save_name != nullptr))
     {
-        ret = tb->run_steps(TICK_TIME);
-        if (ret != 0)
+        printf("SIM: checkpoints aren't supported by +step_loop\n");
+        save_name = nullptr;
+        save_marker = 0;
+    }
+#endif
+    if (step_loop)
+    {
+        for ( ; cycles_cnt<cycles ; ++cycles_cnt)
         {
-            break;
+            ret = tb->run_steps(TICK_TIME);
+            if (ret != 0)
+            {
+                break;
+            }
+        }
+    }
+    else
+    {
+        // cycles per run_cycles() call, console/exit polling is done on each edge
+        uint64_t batch = plusarg_u64(sim_ctx, "batch", SIM_BATCH_CYCLES);
+        uint64_t cycles_start = run.get_cycle();
+        while (cycles_cnt < cycles)
+        {
+            uint64_t count = std::min(batch, cycles - cycles_cnt);
+            if (save_cycle > run.get_cycle())
+            {
+                count = std::min(count, save_cycle - run.get_cycle());
+            }
+            ret = run.run_cycles(count);
+            cycles_cnt = run.get_cycle() - cycles_start;
+            if (ret != 0)
+            {
+                break;
+            }
+            // saved between cycles, so a restored model resumes from the rising edge
+            if ((save_name != nullptr) && (save_pending || (run.get_cycle() == save_cycle)))
+            {
+                SimState state = { run.get_cycle(), sim_ctx->time(), prev_marker, markers };
+                console.flush();
+                sim_checkpoint_save(save_name, top, state);
+                save_name = nullptr;
+                save_pending = false;
+            }
         }
     }
     auto end = std::chrono::system_clock::now();
+    console.close();
+    retire.finish();
     std::chrono::duration<double> elapsed_seconds = end-start;
+
+    // +signature=<file>, memory signature of an arch test (sim/arch_runner.py)
+    const char* signature_file = plusarg_str(sim_ctx, "signature");
+    if ((signature_file != nullptr) && !dump_signature(plusarg_str(sim_ctx, "elf"), signature_file))
+    {
+        ret = -1;
+    }
+
+    // +summary=<file>, JSON record for sim/results_db.py
+    const char* summary_file = plusarg_str(sim_ctx, "summary");
+    if (summary_file != nullptr)
+    {
+        SimSummary sum;
+        sum.name = summary_name();
+        sum.status = (ret == 1) ? "ok" : ((ret < 0) ? "failed" : "limit");
+        sum.cycles = cycles_cnt;
+        sum.core_cycles = 0;
+        sum.instret = 0;
+        if (!sim_cntr_read(CNTR_CYCLE, sum.core_cycles) || !sim_cntr_read(CNTR_INSTRET, sum.instret))
+        {
+            printf("SIM: counters aren't available, instret isn't reported\n");
+        }
+        sum.phases.construct = seconds_between(t_begin, t_model);
+        sum.phases.load = seconds_between(start, t_loaded);
+        sum.phases.reset = seconds_between(t_loaded, t_reset);
+        sum.phases.run = seconds_between(t_reset, end);
+        if (cpi.is_active())
+        {
+            sum.sections.push_back({"cpi_stack", cpi.json()});
+        }
+        if (mix != nullptr)
+        {
+            sum.sections.push_back({"instr_mix", mix->json()});
+        }
+        sim_summary_write(summary_file, sum);
+    }
+
     if (cycles != (uint32_t)-1)
     {
         ret = 0;
@@ -112,7 +684,22 @@ int main(int argc, char** argv, char** env)
         ret = 0;
     }
 
-    printf("Simulation time: %.3f(s), %d/%d cycles\n", elapsed_seconds.count(), cycles_cnt, cycles);
+    cpi.report();
+    if (profile != nullptr)
+    {
+        profile->report(plusarg_u64(sim_ctx, "prof_top", PROFILE_TOP_DEFAULT));
+        const char* folded_name = plusarg_str(sim_ctx, "prof_folded");
+        if (folded_name != nullptr)
+        {
+            profile->write_folded(folded_name);
+        }
+    }
+    if (mix != nullptr)
+    {
+        mix->report();
+    }
+    printf("Simulation time: %.3f(s), %ld/%ld cycles, %.0f cycles/s\n", elapsed_seconds.count(),
+        cycles_cnt, cycles, cycles_cnt / elapsed_seconds.count());
 
     tb->finish();
     top->final();
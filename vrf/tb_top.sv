@@ -2,6 +2,20 @@
 
 /* verilator lint_off UNUSEDSIGNAL */
 module tb_top
+#(
+    // core configuration, overridden by simulation builds (make gparams=...)
+    parameter logic BRANCH_PREDICTION   = 0,
+    parameter int BRANCH_TABLE_SIZE_BITS= 3,
+    parameter int BRANCH_TABLE_WAYS     = 0,
+    parameter int BRANCH_TAG_BITS       = 8,
+    parameter int BRANCH_BHT_SIZE_BITS  = 6,
+    parameter int BRANCH_GHR_BITS       = 0,
+    parameter int INSTR_BUF_ADDR_SIZE   = 2,
+    parameter logic ALU2_ISOLATED       = 1,
+    parameter logic EXTENSION_C         = 1,
+    parameter logic EXTENSION_M         = 1,
+    parameter logic EXTENSION_Zihpm     = 0
+)
 (
     input   wire                        i_clk,
     input   wire                        i_reset_n,
@@ -68,6 +82,19 @@ module tb_top
     );
 
     rv_top_wb
+    #(
+        .BRANCH_PREDICTION              (BRANCH_PREDICTION),
+        .BRANCH_TABLE_SIZE_BITS         (BRANCH_TABLE_SIZE_BITS),
+        .BRANCH_TABLE_WAYS              (BRANCH_TABLE_WAYS),
+        .BRANCH_TAG_BITS                (BRANCH_TAG_BITS),
+        .BRANCH_BHT_SIZE_BITS           (BRANCH_BHT_SIZE_BITS),
+        .BRANCH_GHR_BITS                (BRANCH_GHR_BITS),
+        .INSTR_BUF_ADDR_SIZE            (INSTR_BUF_ADDR_SIZE),
+        .ALU2_ISOLATED                  (ALU2_ISOLATED),
+        .EXTENSION_C                    (EXTENSION_C),
+        .EXTENSION_M                    (EXTENSION_M),
+        .EXTENSION_Zihpm                (EXTENSION_Zihpm)
+    )
     u_rv
     (
         .i_clk                          (w_clk),
@@ -90,6 +117,7 @@ module tb_top
     localparam MAIN_NIC_SLAVE_UART      = 1;
     //localparam MAIN_NIC_SLAVE_I2C       = 2;
     //localparam MAIN_NIC_SLAVE_CCM       = 3;
+    localparam MAIN_NIC_SLAVE_MAILBOX   = 3;
 
     wire[(MAIN_NIC_SLAVES_COUNT-1):0]   w_main_slave_sel;
     wire[(MAIN_NIC_SLAVES_COUNT-1):0]   w_main_slave_ack;
@@ -107,7 +135,9 @@ module tb_top
     assign  w_main_slave_rdata[( 6*32)+:32] = '0;
     assign  w_main_slave_rdata[( 5*32)+:32] = '0;
     assign  w_main_slave_rdata[( 4*32)+:32] = '0;
+`ifndef TO_SIM
     assign  w_main_slave_rdata[( 3*32)+:32] = '0;
+`endif
     assign  w_main_slave_ack[15] = '1;
     assign  w_main_slave_ack[14] = '0;
     assign  w_main_slave_ack[13] = '0;
@@ -120,7 +150,9 @@ module tb_top
     assign  w_main_slave_ack[ 6] = '0;
     assign  w_main_slave_ack[ 5] = '0;
     assign  w_main_slave_ack[ 4] = '0;
+`ifndef TO_SIM
     assign  w_main_slave_ack[ 3] = '0;
+`endif
 
     nic
     #(
@@ -139,7 +171,13 @@ module tb_top
         .o_ack                          (w_wb_ack)
     );
 
+    wire    w_tcm_ack;
+
+`ifdef TCM_DPI
+    tcm_dpi
+`else
     tcm
+`endif
     #(
         .MEM_ADDR_WIDTH                 (`TCM_ADDR_WIDTH)
     )
@@ -151,10 +189,29 @@ module tb_top
         .i_sel                          (w_wb_sel),
         .i_write                        (w_wb_we),
         .i_data                         (w_wb_wdata),
-        .o_ack                          (w_main_slave_ack[MAIN_NIC_SLAVE_TCM]),
+        .o_ack                          (w_tcm_ack),
         .o_data                         (w_main_slave_rdata[MAIN_NIC_SLAVE_TCM*32+:32])
     );
 
+`ifdef TO_SIM
+    // memory latency model, +bus_lat_tcm=...
+    sim_bus_delay
+    #(
+        .SLAVE_ID                       (MAIN_NIC_SLAVE_TCM)
+    )
+    u_tcm_delay
+    (
+        .i_clk                          (w_clk),
+        .i_sel                          (w_main_slave_sel[MAIN_NIC_SLAVE_TCM]),
+        .i_addr                         (w_wb_addr),
+        .i_data_req                     (o_debug[1]),
+        .i_ack                          (w_tcm_ack),
+        .o_ack                          (w_main_slave_ack[MAIN_NIC_SLAVE_TCM])
+    );
+`else
+    assign  w_main_slave_ack[MAIN_NIC_SLAVE_TCM] = w_tcm_ack;
+`endif
+
     wire    w_uart_txen;
 
     cmsdk_wb_uart
@@ -185,15 +242,23 @@ module tb_top
     assign  w_main_slave_ack[2] = '1;
     assign  w_main_slave_rdata[2*32+:32] = r_cnt;
 
+`ifdef TO_SIM
+    sim_mailbox
+    u_mailbox
+    (
+        .i_clk                          (w_clk),
+        .i_dev_sel                      (w_main_slave_sel[MAIN_NIC_SLAVE_MAILBOX]),
+        .i_addr                         (w_wb_addr[3:2]),
+        .i_write                        (w_wb_we),
+        .i_data                         (w_wb_wdata),
+        .o_ack                          (w_main_slave_ack[MAIN_NIC_SLAVE_MAILBOX]),
+        .o_data                         (w_main_slave_rdata[MAIN_NIC_SLAVE_MAILBOX*32+:32])
+    );
+`endif
+
 initial
 begin
-`ifdef TO_SIM
-    string fw_file;
-    if ($value$plusargs("TEST_FW=%s", fw_file))
-        $readmemh(fw_file, u_tcm.r_mem);
-    else
-        $readmemh("fw.vh", u_tcm.r_mem);
-`else
+`ifndef TO_SIM
   `ifndef QUARTUS
         $readmemh("../fw/test/out/riscv.vh", u_tcm.mem);
   `endif
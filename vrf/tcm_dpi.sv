@@ -0,0 +1,67 @@
+`timescale 1ps/1ps
+
+// Simulation-only replacement of tcm (make tcm=dpi): the memory is a sparse
+// paged array of the harness (vrf/sim_mem.h), the bus timing is the same.
+module tcm_dpi
+#
+(
+    parameter int MEM_ADDR_WIDTH        = 8
+)
+(
+    input   wire                        i_clk,
+    input   wire                        i_dev_sel,
+    input   wire[(MEM_ADDR_WIDTH+1):2]  i_addr,
+    input   wire[3:0]                   i_sel,
+    input   wire                        i_write,
+    input   wire[31:0]                  i_data,
+    output  wire                        o_ack,
+    output  wire[31:0]                  o_data
+);
+
+    import "DPI-C" function void tcm_dpi_init(input int addr_width);
+    import "DPI-C" function void tcm_dpi_load(input string file_name);
+    import "DPI-C" function int tcm_dpi_read(input int idx);
+    import "DPI-C" function void tcm_dpi_write(input int idx, input int data, input int sel);
+
+    logic       r_ack;
+    logic[(MEM_ADDR_WIDTH+1):2] addr;
+    logic[3:0]                  sel;
+    logic[31:0]                 wdata;
+    logic                       write;
+    logic[31:0]                 r_rdata;
+
+    always_ff @(posedge i_clk)
+    begin
+        addr <= i_addr;
+        sel <= i_sel;
+        wdata <= i_data;
+        write <= i_write;
+    end
+
+    // write goes first, so the read of the same word returns the new data as tcm does
+    always_ff @(posedge i_clk)
+    begin
+        if (write & r_ack)
+            tcm_dpi_write(int'(addr), wdata, int'(sel));
+        r_rdata <= tcm_dpi_read(int'(i_addr));
+    end
+
+    always_ff @(posedge i_clk)
+    begin
+        r_ack <= i_dev_sel;
+    end
+
+    assign  o_data = r_rdata;
+    assign  o_ack = r_ack;
+
+    initial
+    begin
+        string fw_file;
+        tcm_dpi_init(MEM_ADDR_WIDTH);
+        if ($value$plusargs("TEST_FW=%s", fw_file))
+            tcm_dpi_load(fw_file);
+        else if (!$test$plusargs("elf=")) // +elf= is loaded by the harness
+            tcm_dpi_load("fw.vh");
+    end
+
+endmodule